@@ -0,0 +1,106 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "parsers/osm/osm_graph_factory.h"
+#include "impl/csr_graph.h"
+#include "routing/alt.h"
+#include "routing/astar.h"
+#include "routing/bidirectional_astar.h"
+#include "routing/contraction_hierarchy.h"
+#include "routing/dijkstra.h"
+
+
+//--------------------  Benchmark ----------------------------
+
+/// Runs the same queries, given as indices of the parsed graph, with one strategy and reports how
+/// fast it settles nodes.
+void run(const char* order, const char* name, const routing::CsrGraph& graph,
+         const routing::RoutingStrategy& strategy, const std::vector<std::pair<uint32_t, uint32_t> >& queries) {
+    // queries are numbered like the parsed graph, the searches like this one
+    std::vector<uint32_t> index(graph.NodeCount());
+    for (uint32_t i = 0; i < graph.NodeCount(); i++) {
+        index[graph.SourceIndex(i)] = i;
+    }
+
+    uint64_t before = strategy.SettledNodes();
+    double length = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (const std::pair<uint32_t, uint32_t>& query : queries) {
+        std::vector<uint32_t> path = strategy.GetIndexPath(graph, index[query.first], index[query.second]);
+        for (size_t i = 1; i < path.size(); i++) {
+            for (uint32_t e = graph.EdgeBegin(path[i - 1]); e < graph.EdgeEnd(path[i - 1]); e++) {
+                if (graph.EdgeTarget(e) == path[i]) {
+                    length += graph.EdgeWeight(e);
+                    break;
+                }
+            }
+        }
+    }
+    std::chrono::duration<double> wall = std::chrono::steady_clock::now() - start;
+    uint64_t settled = strategy.SettledNodes() - before;
+
+    std::printf("%-8s %-9s %10.3f %12llu %14.0f %14.1f\n", order, name, wall.count(),
+                static_cast<unsigned long long>(settled), wall.count() > 0 ? settled / wall.count() : 0.0, length);
+}
+
+/// Benchmarks every weighted search on one node order of the graph.
+void runAll(const char* order, const routing::CsrGraph& graph,
+            const std::vector<std::pair<uint32_t, uint32_t> >& queries) {
+    routing::AStar astar;
+    routing::Dijkstra dijkstra;
+    routing::BidirectionalAStar bastar;
+    routing::ALT alt(graph);
+    routing::ContractionHierarchy ch(graph);
+    run(order, "astar", graph, astar, queries);
+    run(order, "dijkstra", graph, dijkstra, queries);
+    run(order, "bastar", graph, bastar, queries);
+    run(order, "alt", graph, alt, queries);
+    run(order, "ch", graph, ch, queries);
+}
+
+
+//--------------------  Main ----------------------------
+
+/// Compares the searches on the parsed node order of a map and on the Hilbert order the routing
+/// graph uses.  The total path length is printed so that the two orders can be checked to agree.
+int main(int argc, char**argv) {
+    std::string map = argc > 1 ? argv[1] : "libs/routing/data/umn.osm";
+    int count = argc > 2 ? std::atoi(argv[2]) : 1000;
+    if (count <= 0) {
+        std::cout << "Usage: ./build/bin/routing_bench [map.osm] [queries]" << std::endl;
+        return 1;
+    }
+
+    std::unique_ptr<routing::IGraph> parsed;
+    try {
+        parsed.reset(routing::OSMGraphFactory().Create(map));
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+    }
+    if (!parsed || parsed->GetNodes().empty()) {
+        std::cerr << "Cannot load map " << map << std::endl;
+        return 1;
+    }
+    routing::CsrGraph source(*parsed, routing::CsrGraph::SourceOrder);
+    routing::CsrGraph hilbert(*parsed, routing::CsrGraph::HilbertOrder);
+
+    // the same random pairs for both orders, from a fixed seed
+    std::mt19937 random(42);
+    std::uniform_int_distribution<uint32_t> node(0, source.NodeCount() - 1);
+    std::vector<std::pair<uint32_t, uint32_t> > queries;
+    for (int i = 0; i < count; i++) {
+        uint32_t from = node(random);
+        queries.push_back(std::make_pair(from, node(random)));
+    }
+
+    std::printf("%-8s %-9s %10s %12s %14s %14s\n", "order", "strategy", "seconds", "settled", "settled/s", "length");
+    runAll("source", source, queries);
+    runAll("hilbert", hilbert, queries);
+    return 0;
+}
@@ -1,149 +1,212 @@
+#include <algorithm>
 #include <map>
+#include <atomic>
 #include <chrono>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
 #include "WebServer.h"
 #include "SimulationModel.h"
 #include "routing_api.h"
+#include "impl/csr_graph.h"
+#include "routing/route_cache.h"
 
 
-//--------------------  Controller ----------------------------
+//--------------------  Simulation Clock ----------------------------
 
-/// A Transit Service that communicates with a web page through web sockets.  It also acts as the controller
-/// in the model view controller pattern.
-class TransitService : public JsonSession, public IController {
+/// Advances the model on its own thread at a fixed tick rate, independent of
+/// how many viewers are connected or how fast their browsers draw.  Anything
+/// else that touches the model must hold getMutex().
+class SimulationClock {
 public:
-    TransitService(SimulationModel& model) : model(model), start(std::chrono::system_clock::now()), time(0.0) {
-        routing::RoutingAPI api;
-        routing::IGraph* graph = api.LoadFromFile("libs/routing/data/umn.osm");
-        model.setGraph(graph);
+    SimulationClock(SimulationModel& model, double ticksPerSecond) : model(model), tick(1.0 / ticksPerSecond), speed(1.0), running(false) {}
+    ~SimulationClock() { stop(); }
+
+    /// Starts ticking, calling onTick from the clock thread after every step.
+    void start(std::function<void()> onTick) {
+        this->onTick = onTick;
+        running = true;
+        thread = std::thread(&SimulationClock::run, this);
+    }
+
+    void stop() {
+        running = false;
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+
+    /// Simulated seconds per wall clock second, set from the viewers' slider.
+    void setSpeed(double simSpeed) { speed = simSpeed; }
+
+    std::mutex& getMutex() { return mutex; }
+
+private:
+    void run() {
+        using Clock = std::chrono::steady_clock;
+        Clock::time_point last = Clock::now();
+        Clock::time_point next = last;
+        while (running) {
+            next += std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(tick));
+            std::this_thread::sleep_until(next);
+
+            // step by the time that really passed so a slow tick is caught up
+            Clock::time_point now = Clock::now();
+            double delta = std::chrono::duration<double>(now - last).count() * speed;
+            last = now;
+            if (now - next > std::chrono::seconds(1)) {
+                next = now;
+            }
+
+            {
+                // strategies cover any dt in one step, even when fast-forwarding
+                std::lock_guard<std::mutex> lock(mutex);
+                model.update(delta);
+            }
+            onTick();
+        }
     }
 
+    SimulationModel& model;
+    double tick;
+    std::atomic<double> speed;
+    std::atomic<bool> running;
+    std::mutex mutex;
+    std::thread thread;
+    std::function<void()> onTick;
+};
+
+
+//--------------------  Controller ----------------------------
+
+/// A Transit Service that communicates with a web page through web sockets.  Commands from the page
+/// are applied to the shared model; the simulation itself is advanced by the SimulationClock.
+class TransitService : public JsonSession {
+public:
+    TransitService(SimulationModel& model, SimulationClock& clock) : model(model), clock(clock) {}
+
     /// Handles specific commands from the web server
     void receiveCommand(const std::string& cmd, JsonObject& data, JsonObject& returnValue) {
         // std::cout << cmd << ": " << data << std::endl;
         if (cmd == "CreateEntity") {
+            std::lock_guard<std::mutex> lock(clock.getMutex());
             model.createEntity(data);
         }
         else if (cmd == "ScheduleTrip") {
+            std::lock_guard<std::mutex> lock(clock.getMutex());
             model.scheduleTrip(data);
         }
+        else if (cmd == "UpdateRoad") {
+            std::lock_guard<std::mutex> lock(clock.getMutex());
+            model.updateRoad(data);
+        }
         else if (cmd == "ping") {
             returnValue["response"] = data;
         }
         else if (cmd == "Update") {
-            updateEntites.clear();
-
-            std::chrono::time_point<std::chrono::system_clock> end = std::chrono::system_clock::now();
-            std::chrono::duration<double> diff = end - start;
-            double delta = diff.count() - time;
-            time += delta;
-
+            // the clock thread steps the model, the page only picks the speed
             double simSpeed = data["simSpeed"];
-            delta *= simSpeed;
-
-            if (delta > 0.1) {
-                for (float f = 0.0; f < delta; f+=0.01) {
-                    model.update(0.01);
-                }
-            }
-            else {
-                model.update(delta);
-            }
-
-            for (auto& [id, entity] : updateEntites) {
-                sendEntity("UpdateEntity", *entity);
-            }
+            clock.setSpeed(simSpeed);
         }
         else if (cmd == "stopSimulation")
         {
             std::cout << "Stop command administered\n";
+            std::lock_guard<std::mutex> lock(clock.getMutex());
             model.stop();
         }
     }
 
-    void sendEntity(const std::string& event, const IEntity& entity, bool includeDetails = true) {
-        //JsonObject details = entity.GetDetails();
-        JsonObject details;
-        if (includeDetails) {
-            details["details"] = entity.getDetails();
-        }
-        details["id"] = entity.getId();
-        Vector3 pos_ = entity.getPosition();
-        Vector3 dir_ = entity.getDirection();
-        JsonArray pos = {pos_.x, pos_.y, pos_.z};
-        JsonArray dir = {dir_.x, dir_.y, dir_.z};
-        details["pos"] = pos;
-        details["dir"] = dir;
-        std::string col_ = entity.getColor();
-        if(col_ != "") details["color"] = col_;
-        sendEventToView(event, details);
-    }
-
-    void addEntity(const IEntity& entity) {
-        sendEntity("AddEntity", entity, true);
-    }
-    
-    void updateEntity(const IEntity& entity) {
-        updateEntites[entity.getId()] = &entity;
-    }
-
-    void removeEntity(const IEntity& entity) {
-        JsonObject details;
-        details["id"] = entity.getId();
-        updateEntites.erase(entity.getId());
-        sendEventToView("RemoveEntity", details);
-    }
-
-    /// Allows messages to be passed back to the view
-    void sendEventToView(const std::string& event, const JsonObject& details) {
-        JsonObject eventData;
-        eventData["event"] = event;
-        eventData["details"] = details;
-        sendMessage(eventData.toString());
-    }
-
-    void stop() {}
-
-    bool isAlive(){ return true; }
-
 private:
     // Simulation Model
     SimulationModel& model;
-    // Used for tracking time since last update
-    std::chrono::time_point<std::chrono::system_clock> start;
-    // The total time the server has been running.
-    double time;
-    // Current entities to update
-    std::map<int, const IEntity*> updateEntites;
+    // Advances the model and guards it
+    SimulationClock& clock;
 };
 
 
 //--------------------  View / Web Server Code ----------------------------
 
-/// The TransitWebServer holds the simulation and updates sessions.
+/// The TransitWebServer holds the simulation and updates sessions.  The model reports changes from the
+/// clock thread; they are serialized there and published to the sessions from the network thread.
 class TransitWebServer : public WebServerBase, public IController {
 public:
-	TransitWebServer(int port = 8081, const std::string& webDir = ".") : WebServerBase(port, webDir), model(*this), alive_(true) {}
-    void addEntity(const IEntity& entity) {
-        for (int i = 0; i < sessions.size(); i++) {
-            static_cast<TransitService*>(sessions[i])->addEntity(entity);
+	TransitWebServer(int port = 8081, const std::string& webDir = ".", double ticksPerSecond = 60.0, int threads = 1)
+        : WebServerBase(port, webDir), model(*this), clock(model, ticksPerSecond), alive_(true) {
+        routeCache = std::make_shared<routing::RouteCache>(4096);
+        // loaded once for the whole process, sessions only share the model
+        graph = loadGraph(routeCache);
+        // routes found in earlier runs on the same map are reused, the file is only a cache
+        if (const routing::GraphBase* base = dynamic_cast<const routing::GraphBase*>(graph.get())) {
+            graphFingerprint = base->GetRoutingGraph().Fingerprint();
+        }
+        try {
+            routeCache->Load(routeFile, graphFingerprint);
+        }
+        catch (const std::exception&) {
         }
+        model.setGraph(graph);
+        model.setThreadCount(threads);
+        // long searches would stall the clock, so routes are planned off it
+        model.setPlannerThreadCount(2);
+        // drones on the customizable hierarchy follow the road updates
+        model.setReplanRoutes(true);
+        // wake the network thread so it publishes what the tick changed
+        clock.start([this]() { lws_cancel_service(context); });
     }
-    
-    void updateEntity(const IEntity& entity) {
-        for (int i = 0; i < sessions.size(); i++) {
-            static_cast<TransitService*>(sessions[i])->updateEntity(entity);
+
+    ~TransitWebServer() {
+        clock.stop();
+        try {
+            routeCache->Save(routeFile, graphFingerprint);
+        }
+        catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
         }
     }
 
+    void addEntity(const IEntity& entity) {
+        std::lock_guard<std::mutex> lock(outboxMutex);
+        events.push_back(entityMessage("AddEntity", entity));
+    }
+
+    void updateEntity(const IEntity& entity) {
+        std::lock_guard<std::mutex> lock(outboxMutex);
+        updates[entity.getId()] = entityMessage("UpdateEntity", entity);
+    }
+
     void removeEntity(const IEntity& entity) {
-        for (int i = 0; i < sessions.size(); i++) {
-            static_cast<TransitService*>(sessions[i])->removeEntity(entity);
-        }
+        JsonObject details;
+        details["id"] = entity.getId();
+        std::lock_guard<std::mutex> lock(outboxMutex);
+        updates.erase(entity.getId());
+        events.push_back(eventMessage("RemoveEntity", details));
     }
 
     void sendEventToView(const std::string& event, const JsonObject& details) {
+        std::lock_guard<std::mutex> lock(outboxMutex);
+        events.push_back(eventMessage(event, details));
+    }
+
+    /// Sends everything the model reported since the last call to every session.  Only the latest
+    /// state of each entity is sent, however many ticks ran in between.
+    void publish() {
+        std::vector<std::string> pendingEvents;
+        std::map<int, std::string> pendingUpdates;
+        {
+            std::lock_guard<std::mutex> lock(outboxMutex);
+            pendingEvents.swap(events);
+            pendingUpdates.swap(updates);
+        }
         for (int i = 0; i < sessions.size(); i++) {
-            static_cast<TransitService*>(sessions[i])->sendEventToView(event, details);
+            for (const std::string& message : pendingEvents) {
+                sessions[i]->sendMessage(message);
+            }
+            for (auto& [id, message] : pendingUpdates) {
+                sessions[i]->sendMessage(message);
+            }
         }
     }
 
@@ -151,10 +214,56 @@ public:
     bool isAlive() { return alive_; }
 
 protected:
-	Session* createSession() { return new TransitService(model); }
+	Session* createSession() { return new TransitService(model, clock); }
 private:
+    static constexpr const char* routeFile = "libs/routing/data/umn.routes";
+
+    static std::shared_ptr<const routing::IGraph> loadGraph(std::shared_ptr<routing::RouteCache> routeCache) {
+        // later starts map the snapshot instead of parsing the map again; the
+        // first one parses it on every core
+        routing::RoutingAPI api(std::max(1u, std::thread::hardware_concurrency()));
+        routing::IGraph* graph = api.LoadWithSnapshot("libs/routing/data/umn.osm");
+        if (routing::GraphBase* base = dynamic_cast<routing::GraphBase*>(graph)) {
+            base->SetRouteCache(routeCache);
+        }
+        return std::shared_ptr<const routing::IGraph>(graph);
+    }
+
+    static std::string eventMessage(const std::string& event, const JsonObject& details) {
+        JsonObject eventData;
+        eventData["event"] = event;
+        eventData["details"] = details;
+        return eventData.toString();
+    }
+
+    static std::string entityMessage(const std::string& event, const IEntity& entity, bool includeDetails = true) {
+        JsonObject details;
+        if (includeDetails) {
+            details["details"] = entity.getDetails();
+        }
+        details["id"] = entity.getId();
+        Vector3 pos_ = entity.getPosition();
+        Vector3 dir_ = entity.getDirection();
+        JsonArray pos = {pos_.x, pos_.y, pos_.z};
+        JsonArray dir = {dir_.x, dir_.y, dir_.z};
+        details["pos"] = pos;
+        details["dir"] = dir;
+        std::string col_ = entity.getColor();
+        if(col_ != "") details["color"] = col_;
+        return eventMessage(event, details);
+    }
+
+    std::shared_ptr<routing::RouteCache> routeCache;
+    std::shared_ptr<const routing::IGraph> graph;
+    // identifies the map in the saved route cache
+    uint64_t graphFingerprint = 0;
+    // filled by the clock thread, drained by publish()
+    std::mutex outboxMutex;
+    std::vector<std::string> events;
+    std::map<int, std::string> updates;
     SimulationModel model;
-    bool alive_;
+    SimulationClock clock;
+    std::atomic<bool> alive_;
 };
 
 /// The main program that handles starting the web sockets service.
@@ -162,13 +271,19 @@ int main(int argc, char**argv) {
     if (argc > 1) {
         int port = std::atoi(argv[1]);
         std::string webDir = std::string(argv[2]);
-        TransitWebServer server(port, webDir);
+        double ticksPerSecond = argc > 3 ? std::atof(argv[3]) : 60.0;
+        if (ticksPerSecond <= 0) {
+            ticksPerSecond = 60.0;
+        }
+        int threads = argc > 4 ? std::atoi(argv[4]) : 1;
+        TransitWebServer server(port, webDir, ticksPerSecond, threads);
         while (server.isAlive()) {
             server.service();
+            server.publish();
         }
     }
     else {
-        std::cout << "Usage: ./build/bin/transit_service <port> apps/transit_service/web/" << std::endl;
+        std::cout << "Usage: ./build/bin/transit_service <port> apps/transit_service/web/ [ticks per second] [threads]" << std::endl;
     }
 
     return 0;
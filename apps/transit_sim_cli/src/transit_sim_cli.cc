@@ -0,0 +1,215 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "SimulationModel.h"
+#include "routing_api.h"
+#include "routing/astar.h"
+#include "routing/bidirectional_astar.h"
+#include "routing/bidirectional_dijkstra.h"
+#include "routing/dijkstra.h"
+#include "routing/route_cache.h"
+
+
+//--------------------  Controller ----------------------------
+
+/// Controller for headless runs.  Nothing is drawn; the only events it looks at are deliveries being
+/// scheduled and completed, from which it measures delivery latency in simulated seconds.
+class NullController : public IController {
+public:
+    NullController() : now(0.0), scheduled(0), completed(0), totalLatency(0.0), alive(true) {}
+
+    void addEntity(const IEntity& entity) {}
+    void updateEntity(const IEntity& entity) {}
+    void removeEntity(const IEntity& entity) {}
+
+    void sendEventToView(const std::string& event, const JsonObject& details) {
+        if (event == "DeliveryScheduled") {
+            std::string name = details["name"];
+            pending[name].push_back(now);
+            scheduled++;
+        }
+        else if (event == "DeliveryCompleted") {
+            std::string name = details["name"];
+            std::deque<double>& times = pending[name];
+            if (!times.empty()) {
+                totalLatency += now - times.front();
+                times.pop_front();
+            }
+            completed++;
+        }
+    }
+
+    void stop() { alive = false; }
+    bool isAlive() { return alive; }
+
+    /// Simulated time, used to stamp the events.
+    double now;
+    int scheduled;
+    int completed;
+    double totalLatency;
+
+private:
+    // schedule times of the deliveries still under way, by trip name
+    std::map<std::string, std::deque<double> > pending;
+    bool alive;
+};
+
+
+//--------------------  Scenario ----------------------------
+
+/// A command from a scene or trip file, issued once the simulation reaches its time.
+struct Command {
+    double time;
+    std::string command;
+    JsonObject params;
+};
+
+/// Reads a JSON array of {"command", "params"} objects like web/scenes/umn.json.  Entries may carry
+/// a "time" in simulated seconds, the others are issued at the start.
+bool loadCommands(const std::string& file, std::vector<Command>& commands) {
+    std::ifstream in(file.c_str());
+    if (!in) {
+        std::cerr << "Cannot open " << file << std::endl;
+        return false;
+    }
+    std::stringstream text;
+    text << in.rdbuf();
+
+    picojson::value value;
+    std::string err = picojson::parse(value, text.str());
+    if (!err.empty() || !value.is<picojson::array>()) {
+        std::cerr << "Cannot parse " << file << ": " << err << std::endl;
+        return false;
+    }
+
+    for (const picojson::value& entry : value.get<picojson::array>()) {
+        if (!entry.is<picojson::object>()) {
+            continue;
+        }
+        const picojson::object& object = entry.get<picojson::object>();
+        auto command = object.find("command");
+        auto params = object.find("params");
+        if (command == object.end() || params == object.end() || !params->second.is<picojson::object>()) {
+            continue;
+        }
+        auto time = object.find("time");
+        Command c;
+        c.time = time != object.end() && time->second.is<double>() ? time->second.get<double>() : 0.0;
+        c.command = command->second.to_str();
+        c.params = JsonObject(params->second.get<picojson::object>());
+        commands.push_back(c);
+    }
+    return true;
+}
+
+
+//--------------------  Main ----------------------------
+
+/// Runs a scenario as fast as possible and prints summary statistics as JSON.
+int main(int argc, char**argv) {
+    if (argc < 4) {
+        std::cout << "Usage: ./build/bin/transit_sim_cli <scene.json> <trips.json> <simulated seconds> [dt] [map] [threads]" << std::endl;
+        std::cout << "Example: ./build/bin/transit_sim_cli apps/transit_service/web/scenes/umn.json apps/transit_sim_cli/scenarios/trips.json 600" << std::endl;
+        return 1;
+    }
+    double duration = std::atof(argv[3]);
+    double dt = argc > 4 ? std::atof(argv[4]) : 0.1;
+    std::string map = argc > 5 ? argv[5] : "libs/routing/data/umn.osm";
+    int threads = argc > 6 ? std::atoi(argv[6]) : 1;
+    if (duration <= 0 || dt <= 0) {
+        std::cerr << "The duration and dt must be positive" << std::endl;
+        return 1;
+    }
+
+    std::vector<Command> commands;
+    if (!loadCommands(argv[1], commands) || !loadCommands(argv[2], commands)) {
+        return 1;
+    }
+    std::stable_sort(commands.begin(), commands.end(),
+        [](const Command& a, const Command& b) { return a.time < b.time; });
+
+    routing::RoutingAPI api(std::max(threads, 1));
+    routing::IGraph* loaded = api.LoadWithSnapshot(map);
+    if (!loaded) {
+        std::cerr << "Cannot load map " << map << std::endl;
+        return 1;
+    }
+    // kept in memory only, so every run starts from the same state
+    std::shared_ptr<routing::RouteCache> routeCache = std::make_shared<routing::RouteCache>(4096);
+    if (routing::GraphBase* base = dynamic_cast<routing::GraphBase*>(loaded)) {
+        base->SetRouteCache(routeCache);
+    }
+    std::shared_ptr<const routing::IGraph> graph(loaded);
+
+    NullController controller;
+    SimulationModel model(controller);
+    model.setGraph(graph);
+    model.setThreadCount(threads);
+    model.setReplanRoutes(true);
+
+    // the entities log every step, which would dominate a headless run
+    std::streambuf* console = std::cout.rdbuf(nullptr);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    size_t next = 0;
+    long ticks = 0;
+    while (controller.now < duration && controller.isAlive()) {
+        while (next < commands.size() && commands[next].time <= controller.now) {
+            Command& c = commands[next++];
+            if (c.command == "CreateEntity") {
+                model.createEntity(c.params);
+            }
+            else if (c.command == "ScheduleTrip") {
+                model.scheduleTrip(c.params);
+            }
+            else if (c.command == "UpdateRoad") {
+                model.updateRoad(c.params);
+            }
+        }
+        model.update(dt);
+        controller.now += dt;
+        ticks++;
+    }
+    std::chrono::duration<double> wall = std::chrono::steady_clock::now() - start;
+
+    std::cout.rdbuf(console);
+    std::cout.clear();
+
+    JsonObject stats;
+    stats["simulatedSeconds"] = controller.now;
+    stats["wallSeconds"] = wall.count();
+    stats["ticks"] = static_cast<double>(ticks);
+    stats["ticksPerSecond"] = wall.count() > 0 ? ticks / wall.count() : 0.0;
+    stats["deliveriesScheduled"] = controller.scheduled;
+    stats["deliveriesCompleted"] = controller.completed;
+    stats["meanDeliveryLatency"] = controller.completed > 0 ? controller.totalLatency / controller.completed : 0.0;
+    stats["routeCacheHits"] = static_cast<double>(routeCache->Hits());
+    stats["routeCacheMisses"] = static_cast<double>(routeCache->Misses());
+    // nodes settled by the weighted searches, to compare their cost
+    JsonObject settled;
+    settled["astar"] = static_cast<double>(routing::AStar::Default().SettledNodes());
+    settled["dijkstra"] = static_cast<double>(routing::Dijkstra::Instance().SettledNodes());
+    settled["bastar"] = static_cast<double>(routing::BidirectionalAStar::Default().SettledNodes());
+    settled["bdijkstra"] = static_cast<double>(routing::BidirectionalDijkstra::Instance().SettledNodes());
+    if (model.getLandmarkAStar()) {
+        settled["alt"] = static_cast<double>(model.getLandmarkAStar()->SettledNodes());
+    }
+    if (model.getContractionHierarchy()) {
+        settled["ch"] = static_cast<double>(model.getContractionHierarchy()->SettledNodes());
+    }
+    if (model.getCustomizableHierarchy()) {
+        settled["cch"] = static_cast<double>(model.getCustomizableHierarchy()->SettledNodes());
+    }
+    stats["settledNodes"] = settled;
+    std::cout << stats << std::endl;
+
+    return 0;
+}
@@ -1,14 +1,39 @@
 #ifndef DISTANCE_FUNCTION_H_
 #define DISTANCE_FUNCTION_H_
 
+#include <cmath>
+#include <vector>
+
 namespace routing {
 
+// A position held by value, the fixed size form the searches use instead of
+// a std::vector<float>.
+struct Float3 {
+	float x;
+	float y;
+	float z;
+
+	Float3() : x(0), y(0), z(0) {}
+	Float3(float x, float y, float z) : x(x), y(y), z(z) {}
+	explicit Float3(const float* p) : x(p[0]), y(p[1]), z(p[2]) {}
+	// missing coordinates are 0
+	explicit Float3(const std::vector<float>& v)
+		: x(v.size() > 0 ? v[0] : 0), y(v.size() > 1 ? v[1] : 0), z(v.size() > 2 ? v[2] : 0) {}
+
+	std::vector<float> ToVector() const { return {x, y, z}; }
+};
+
 class DistanceFunction {
 public:
 	virtual ~DistanceFunction() {}
 	virtual float Calculate(const std::vector<float>& a, const std::vector<float>& b) const = 0;
+	// The same distance without allocating.  The default copies the
+	// positions into vectors for Calculate.
+	virtual float Between(const Float3& a, const Float3& b) const { return Calculate(a.ToVector(), b.ToVector()); }
 };
 
+// The built-in distances also have a static Distance, which the searches
+// call directly when they know the type so that it is inlined.
 class EuclideanDistance : public DistanceFunction {
 public:
 	virtual ~EuclideanDistance() {}
@@ -20,6 +45,14 @@ public:
 		}
 		return std::sqrt(sum);
 	}
+	virtual float Between(const Float3& a, const Float3& b) const { return Distance(a, b); }
+
+	static float Distance(const Float3& a, const Float3& b) {
+		const float dx = b.x - a.x;
+		const float dy = b.y - a.y;
+		const float dz = b.z - a.z;
+		return std::sqrt(dx*dx + dy*dy + dz*dz);
+	}
 };
 
 class ZeroDistance : public DistanceFunction {
@@ -28,6 +61,9 @@ public:
 	virtual float Calculate(const std::vector<float>& a, const std::vector<float>& b) const {
 		return 0;
 	}
+	virtual float Between(const Float3& a, const Float3& b) const { return 0; }
+
+	static constexpr float Distance(const Float3& a, const Float3& b) { return 0; }
 };
 
 }
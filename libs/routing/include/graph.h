@@ -5,14 +5,20 @@
 #include <string>
 #include <vector>
 #include <cmath>
+#include <cstdint>
+#include <memory>
+#include <mutex>
 #include "routing_strategy.h"
 #include "distance_function.h"
 #include "bounding_box.h"
+#include "spatial_index.h"
 
 namespace routing {
 
 class IGraphNode;
 class RoutingStrategy;
+class RouteCache;
+class CsrGraph;
 
 class IGraph {
 public:
@@ -24,20 +30,71 @@ public:
 	virtual const std::vector< std::vector<float> > GetPath(std::vector<float> src, std::vector<float> dest, const RoutingStrategy& strategy) const = 0;
 };
 
+// An edge to a neighbor with its cost, computed once when the graph is
+// loaded: the length of the edge times a multiplier, 1 unless the loader
+// says otherwise.  Multipliers below 1 would let the euclidean heuristic of
+// A* overestimate.
+struct WeightedNeighbor {
+	IGraphNode* node;
+	float weight;
+};
+
 class IGraphNode {
 public:
 	virtual ~IGraphNode() {}
 	virtual const std::string& GetName() const = 0;
 	virtual const std::vector<IGraphNode*>& GetNeighbors() const = 0;
+	// GetNeighbors in the same order, with the edge weights.
+	virtual const std::vector<WeightedNeighbor>& WeightedNeighbors() const = 0;
 	virtual const std::vector<float> GetPosition() const = 0;
+	// The position without allocating, missing coordinates being 0.  The
+	// default copies GetPosition; the graphs of this library override it.
+	virtual Float3 GetPoint() const { return Float3(GetPosition()); }
 };
 
 class GraphBase : public IGraph {
 public:
-	virtual ~GraphBase() {}
+	GraphBase() : spatialIndex(NULL), routingGraph(NULL) {}
+	virtual ~GraphBase();
 	BoundingBox GetBoundingBox() const;
 	const IGraphNode* NearestNode(std::vector<float> point, const DistanceFunction& distance) const;
 	const std::vector< std::vector<float> > GetPath(std::vector<float> src, std::vector<float> dest, const RoutingStrategy& strategy) const;
+	// The nodes GetPath returns the positions of, as positions in GetNodes():
+	// the node nearest to src, the path the strategy finds on
+	// GetRoutingGraph() and the node nearest to dest.  No node names are
+	// looked up.  Empty if the graph has no nodes.
+	std::vector<uint32_t> GetIndexPath(std::vector<float> src, std::vector<float> dest, const RoutingStrategy& strategy) const;
+	// The graph the searches of GetPath run on, with node i being
+	// GetNodes()[i] and the numeric node names kept as 64-bit ids.  Built on
+	// first use, so nodes must not be added after the first query.
+	virtual const CsrGraph& GetRoutingGraph() const;
+
+	// Euclidean point queries answered by the graph's spatial index, which is
+	// built on first use.  Nodes must not be added after the first query.
+	std::vector<const IGraphNode*> NearestNodes(const std::vector< std::vector<float> >& points) const;
+	std::vector<const IGraphNode*> KNearestNodes(std::vector<float> point, uint32_t k) const;
+	std::vector<const IGraphNode*> NodesWithin(std::vector<float> point, float radius) const;
+	const SpatialIndex& GetSpatialIndex() const;
+
+	// GetPath looks routes of named strategies up in the cache and adds the
+	// ones it computes.  Set the cache before the first query.
+	void SetRouteCache(std::shared_ptr<RouteCache> cache) { routeCache = cache; }
+	RouteCache* GetRouteCache() const { return routeCache.get(); }
+
+protected:
+	// Indexes the positions of GetNodes(), ids are positions in that vector.
+	virtual SpatialIndex* BuildSpatialIndex() const;
+
+private:
+	std::vector<const IGraphNode*> ToNodes(const std::vector<uint32_t>& ids) const;
+	// The ids of the nodes nearest to src and dest, false if there are none.
+	bool SnapEnds(std::vector<float> src, std::vector<float> dest, uint32_t& start, uint32_t& end) const;
+
+	mutable std::once_flag spatialIndexBuilt;
+	mutable SpatialIndex* spatialIndex;
+	mutable std::once_flag routingGraphBuilt;
+	mutable CsrGraph* routingGraph;
+	std::shared_ptr<RouteCache> routeCache;
 };
 
 }
@@ -0,0 +1,145 @@
+#ifndef CSR_GRAPH_H_
+#define CSR_GRAPH_H_
+
+#include "graph.h"
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace routing {
+
+class CsrGraph;
+
+// Legacy IGraphNode view of a CsrGraph node.  Only created when a caller asks
+// for the pointer based API; searches use the integer ids directly.
+class CsrGraphNode : public IGraphNode {
+public:
+	CsrGraphNode(const CsrGraph* graph, uint32_t index) : graph(graph), index(index) {}
+	virtual ~CsrGraphNode() {}
+	const std::string& GetName() const;
+	const std::vector<IGraphNode*>& GetNeighbors() const { return neighbors; }
+	const std::vector<WeightedNeighbor>& WeightedNeighbors() const { return weighted; }
+	const std::vector<float> GetPosition() const;
+	Float3 GetPoint() const;
+	uint32_t GetIndex() const { return index; }
+
+private:
+	friend class CsrGraph;
+	const CsrGraph* graph;
+	uint32_t index;
+	std::vector<IGraphNode*> neighbors;
+	std::vector<WeightedNeighbor> weighted;
+};
+
+// Immutable graph in compressed sparse row form.  Node i's outgoing edges are
+// targets[offsets[i]] .. targets[offsets[i+1]-1], each with the weight its
+// source node gave it, and its position is positions[3*i .. 3*i+2].
+//
+// By default the nodes are renumbered along a Hilbert curve through their
+// positions, so that nodes close on the map are close in memory and a search
+// touches few cache lines.  Names resolve as before, and SourceIndex maps a
+// node back to its place in the graph it was built from.
+//
+// The arrays are either built from another graph or memory-mapped from a
+// snapshot written by WriteSnapshot, in which case nothing is parsed and the
+// pages are shared between every process that maps the same file.
+class CsrGraph : public GraphBase {
+public:
+	static constexpr uint32_t InvalidNode = 0xffffffffu;
+	static constexpr uint32_t SnapshotVersion = 3;
+
+	enum NodeOrder { SourceOrder, HilbertOrder };
+
+	CsrGraph(const IGraph& graph, NodeOrder order = HilbertOrder);
+	virtual ~CsrGraph();
+
+	// Maps a snapshot file, throwing std::runtime_error if it is unreadable,
+	// truncated or from another snapshot version.  Given the map file the
+	// snapshot was written from, it also throws if the map's size or
+	// modification time is no longer the one recorded in the snapshot; a map
+	// that cannot be read is not checked.
+	static CsrGraph* MapSnapshot(const std::string& file, const std::string& source = "");
+	// Writes the graph as a snapshot, recording the size and modification time
+	// of source if given.  The file is replaced in one step, so processes that
+	// have the old snapshot mapped keep their copy.  The node names must be
+	// integer ids, as they are for OSM and OBJ graphs, otherwise
+	// std::invalid_argument is thrown.
+	void WriteSnapshot(const std::string& file, const std::string& source = "") const;
+
+	const IGraphNode* GetNode(const std::string& name) const;
+	const std::vector<IGraphNode*>& GetNodes() const;
+	BoundingBox GetBoundingBox() const { return bounds; }
+	const IGraphNode* NearestNode(std::vector<float> point, const DistanceFunction& distance) const;
+	const CsrGraph& GetRoutingGraph() const { return *this; }
+
+	uint32_t NodeCount() const { return nodeCount; }
+	uint32_t EdgeCount() const { return edgeCount; }
+	uint32_t EdgeBegin(uint32_t node) const { return offsets[node]; }
+	uint32_t EdgeEnd(uint32_t node) const { return offsets[node + 1]; }
+	uint32_t EdgeTarget(uint32_t edge) const { return targets[edge]; }
+	float EdgeWeight(uint32_t edge) const { return weights[edge]; }
+	const float* Position(uint32_t node) const { return &positions[3 * node]; }
+	const std::string& NameOf(uint32_t node) const;
+	// The node's numeric name, or its index if the names are not all numeric.
+	uint64_t IdOf(uint32_t node) const { return ids ? ids[node] : node; }
+	uint32_t IndexOf(const std::string& name) const;
+	uint32_t NearestIndex(const float point[3]) const;
+	// Hash of the node names, positions and edges, to tell whether data saved
+	// for a graph, such as a RouteCache, was saved for this one.
+	uint64_t Fingerprint() const;
+	// Index of the node in GetNodes() of the graph this one was built from.
+	uint32_t SourceIndex(uint32_t node) const { return order[node]; }
+
+	// Incoming edges in the same form, built on first use: edge i of
+	// ReverseEdges() runs from sources[i] to the node whose range holds i.
+	struct ReverseEdges {
+		std::vector<uint32_t> offsets;
+		std::vector<uint32_t> sources;
+		std::vector<float> weights;
+	};
+	const ReverseEdges& GetReverseEdges() const;
+
+protected:
+	SpatialIndex* BuildSpatialIndex() const;
+
+private:
+	CsrGraph();
+	void BuildNodeViews() const;
+	void BuildNames() const;
+
+	uint32_t nodeCount;
+	uint32_t edgeCount;
+	const uint32_t* offsets;
+	const uint32_t* targets;
+	const float* weights;
+	const float* positions;
+	// numeric node names, NULL if the source graph had other names
+	const uint64_t* ids;
+	const uint32_t* order;
+	BoundingBox bounds;
+
+	std::vector<uint32_t> ownedOffsets;
+	std::vector<uint32_t> ownedTargets;
+	std::vector<float> ownedWeights;
+	std::vector<float> ownedPositions;
+	std::vector<uint64_t> ownedIds;
+	std::vector<uint32_t> ownedOrder;
+	void* mapping;
+	size_t mappingSize;
+
+	mutable std::once_flag namesBuilt;
+	mutable std::vector<std::string> names;
+	mutable std::unordered_map<std::string, uint32_t> lookup;
+
+	mutable std::once_flag viewsBuilt;
+	mutable std::vector<IGraphNode*> views;
+
+	mutable std::once_flag reverseBuilt;
+	mutable ReverseEdges reverse;
+};
+
+}
+
+#endif
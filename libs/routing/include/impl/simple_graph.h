@@ -10,17 +10,25 @@ namespace routing {
 
 class SimpleGraphNode : public IGraphNode {
 public:
-    SimpleGraphNode(const std::string& name, const std::vector<float>& position) : name(name), position(position) {}
+    SimpleGraphNode(const std::string& name, const std::vector<float>& position) : name(name), position(position), point(position) {}
 	virtual ~SimpleGraphNode() {}
 	const std::string& GetName() const { return name; }
 	const std::vector<IGraphNode*>& GetNeighbors() const { return neighbors; }
+	const std::vector<WeightedNeighbor>& WeightedNeighbors() const { return weighted; }
 	const std::vector<float> GetPosition() const { return position; }
-    void AddNeighbor(IGraphNode* neighbor) { neighbors.push_back(neighbor); }
+	Float3 GetPoint() const { return point; }
+    // the edge weighs its length times 'multiplier'
+    void AddNeighbor(IGraphNode* neighbor, float multiplier = 1.0f) {
+        neighbors.push_back(neighbor);
+        weighted.push_back({neighbor, EuclideanDistance::Distance(point, neighbor->GetPoint()) * multiplier});
+    }
 
 private:
     std::string name;
     std::vector<IGraphNode*> neighbors;
+    std::vector<WeightedNeighbor> weighted;
     std::vector<float> position;
+    Float3 point;
 };
 
 class SimpleGraph : public GraphBase {
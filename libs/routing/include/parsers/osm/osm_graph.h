@@ -1,6 +1,7 @@
 #ifndef OSM_GRAPH_H_
 #define OSM_GRAPH_H_
 
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <iostream>
@@ -17,26 +18,40 @@ namespace routing {
 
 class OSMNode: public IGraphNode {
     public:
-        OSMNode(Point3 loc, string name);
+        OSMNode(Point3 loc, int64_t id);
         Point3 GetLoc() const { return loc_; };
+        int64_t GetId() const { return id_; };
+        // the id in decimal, as in the OSM file
         const string& GetName() const override { return name_; };
-        void AddNeighbour(OSMNode* other) { neighbours_.push_back(other); };
+        // the edge weighs its length times 'multiplier'
+        void AddNeighbour(OSMNode* other, float multiplier = 1.0f) {
+            neighbours_.push_back(other);
+            weighted_.push_back({other, EuclideanDistance::Distance(GetPoint(), other->GetPoint()) * multiplier});
+        };
         const std::vector<IGraphNode*>& GetNeighbors() const override
             {   return neighbours_;
             };
+        const std::vector<WeightedNeighbor>& WeightedNeighbors() const override
+            {   return weighted_;
+            };
         const std::vector<float> GetPosition() const override {
             return loc_.toVec();
         }
+        Float3 GetPoint() const override { return Float3(loc_.p); }
     private:
+        int64_t id_;
         string name_;
         Point3 loc_;
         vector<IGraphNode*> neighbours_; 
+        vector<WeightedNeighbor> weighted_;
 };
 
 class OSMGraph : public GraphBase {
     public:
         ~OSMGraph();
         void AddNode(OSMNode* node);
+        // NULL if there is no node with that id
+        const OSMNode* NodeWithId(int64_t id) const;
         const OSMNode* NodeNamed(const string name) const;
         void AddEdge(const string name1, const string name2);
         bool Contains(const string name) const;
@@ -48,8 +63,10 @@ class OSMGraph : public GraphBase {
 
     private:
         vector<IGraphNode*> nodes_;
-        unordered_map<string, OSMNode*> lookup_;
+        // keyed by OSM id, names are only parsed by the string based calls
+        unordered_map<int64_t, OSMNode*> lookup_;
         OSMNode* node_named(const string name) const;
+        static bool parse_id(const string& name, int64_t& id);
 
 };
 };
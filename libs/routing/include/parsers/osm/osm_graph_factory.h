@@ -7,8 +7,13 @@ namespace routing {
 
 class OSMGraphFactory : public IGraphFactory {
 public:
+	// Files are read by 'threads' threads at once if there is more than one.
+	explicit OSMGraphFactory(unsigned threads = 1) : threads(threads) {}
 	virtual ~OSMGraphFactory() {}
 	virtual IGraph* Create(const std::string& file) const;
+
+private:
+	unsigned threads;
 };
 
 }
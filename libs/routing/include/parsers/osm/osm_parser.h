@@ -1,29 +1,65 @@
 #ifndef ITERATION2_SOLN_SRC_XML_TOOLS_OSM_PARSER_H_
 #define ITERATION2_SOLN_SRC_XML_TOOLS_OSM_PARSER_H_
 
-#include <set>
+#include <cstdint>
 #include <string>
-#include <unordered_map>
-#include <unordered_set>
+#include <utility>
+#include <vector>
 
-#include "util/xml/pugixml.h"
 #include "parsers/osm/osm_graph.h"
 
 using std::string;
-using std::unordered_map;
-using std::unordered_set;
-using std::set;
+using std::vector;
 
 namespace routing {
 
+// Builds the road graph of an OSM XML file: the nodes of ways tagged
+// "highway", joined along each way, reduced to the largest connected
+// component.  The file is streamed twice, first for the ways and then for the
+// positions of the nodes they use, since the nodes come before the ways in an
+// OSM file; nothing else in it is kept, so memory grows with the road graph
+// rather than with the file.
 class OsmParser {
 public:
+  // Seconds spent in each phase of a parallel import.
+  struct Timings {
+    double ways;        // reading the highway segments of every chunk
+    double adjacency;   // merging the segments of the chunks
+    double nodes;       // reading and projecting the nodes of every chunk
+    double components;  // union-find over the segments
+    double graph;       // building the graph of the largest component
+  };
+
+  // Reads the graph on the calling thread.
   static OSMGraph* LoadGraphFromFile(string filename, bool debug);
+  // Reads the graph with both passes split into chunks of the file that
+  // 'threads' threads read at once; the graph is the same for any number of
+  // threads, its nodes in the order of the file.  The phase timings are
+  // stored in 'timings' if given and printed if debug.
+  static OSMGraph* LoadGraphFromFile(string filename, bool debug, unsigned threads, Timings* timings = NULL);
 private:
-  static OSMGraph* read_nodes(pugi::xml_document* doc, bool debug = false);
-  static void read_adjacencies_to(OSMGraph* graph, pugi::xml_document* doc, bool debug=false);
-  static unordered_map<string, set<string>> get_adjacency_list_from_file(pugi::xml_document* doc, bool debug = false);
-  static OSMGraph* without_lonely_nodes(OSMGraph* graph);
+  struct Bounds {
+    float minlat;
+    float minlon;
+    float maxlat;
+    float maxlon;
+  };
+
+  // a highway node as read from the file: its place among the sorted ids
+  // and its projected position
+  struct Located {
+    uint32_t index;
+    Point3 loc;
+  };
+
+  // Both directions of every segment of the highways whose tag starts in
+  // [begin, end), keyed by 64-bit node ids.  Returns whether the bounds were
+  // in that range.
+  static bool read_highways(const string& filename, uint64_t begin, uint64_t end,
+                            vector<std::pair<int64_t, int64_t>>& edges, Bounds& bounds);
+  // The nodes among 'ids' whose tag starts in [begin, end), in file order.
+  static void read_nodes(const string& filename, uint64_t begin, uint64_t end, const Bounds& bounds,
+                         const vector<int64_t>& ids, vector<Located>& located);
 
   static float normalize(float val, float max, float min);
   static float asRadians(float degrees);
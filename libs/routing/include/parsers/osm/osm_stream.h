@@ -0,0 +1,73 @@
+#ifndef ROUTING_OSM_STREAM_H_
+#define ROUTING_OSM_STREAM_H_
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace routing {
+
+// Reads the tags of an OSM XML file one at a time through a fixed size
+// buffer, so memory does not grow with the file.  Text, comments, processing
+// instructions and declarations are skipped; only tags and their attributes
+// are reported.
+class OsmStream {
+public:
+  enum TagType { Open, Close, Empty };
+
+  struct Tag {
+    TagType type;
+    std::string name;
+    // Value of the attribute, or NULL if the tag does not have it.
+    const char* Attribute(const char* attribute) const;
+
+    // attributes[0..count-1] are valid; the strings are reused between tags
+    std::vector<std::pair<std::string, std::string>> attributes;
+    size_t count;
+  };
+
+  // Throws std::runtime_error if the file cannot be opened.  Reading starts
+  // at the first tag at or after byte 'begin', which lets several streams
+  // share one file; 'begin' must not fall inside a comment or CDATA section,
+  // which OSM files do not use.
+  explicit OsmStream(const std::string& filename, uint64_t begin = 0);
+  ~OsmStream();
+
+  // Reads the next tag into 'tag', returning false at the end of the file.
+  // Throws std::runtime_error if the file ends inside a tag.
+  bool Next(Tag& tag);
+  // Byte offset of the '<' that opened the last tag read.
+  uint64_t Offset() const { return offset; }
+
+  // Size of the file in bytes, throwing std::runtime_error if it cannot be
+  // opened.
+  static uint64_t FileSize(const std::string& filename);
+
+private:
+  OsmStream(const OsmStream&);
+  OsmStream& operator=(const OsmStream&);
+
+  // next character, or EOF
+  int get() { return pos < end || fill() ? static_cast<unsigned char>(buffer[pos++]) : EOF; }
+  int peek() { return pos < end || fill() ? static_cast<unsigned char>(buffer[pos]) : EOF; }
+  bool fill();
+  int get_in_tag();
+  void skip_past(const char* terminator);
+  void read_name(int first, std::string& name);
+  void read_value(int quote, std::string& value);
+
+  std::string filename;
+  FILE* file;
+  std::vector<char> buffer;
+  // file offset of buffer[0]
+  uint64_t base;
+  size_t pos;
+  size_t end;
+  uint64_t offset;
+};
+
+};  // namespace routing
+
+#endif  // ROUTING_OSM_STREAM_H_
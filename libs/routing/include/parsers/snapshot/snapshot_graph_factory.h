@@ -0,0 +1,24 @@
+#ifndef SNAPSHOT_GRAPH_FACTORY_H_
+#define SNAPSHOT_GRAPH_FACTORY_H_
+
+#include "graph_factory.h"
+#include "impl/csr_graph.h"
+
+namespace routing {
+
+// Maps binary graph snapshots written by RoutingAPI::SaveSnapshot.
+class SnapshotGraphFactory : public IGraphFactory {
+public:
+	virtual ~SnapshotGraphFactory() {}
+	virtual IGraph* Create(const std::string& file) const {
+		if (file.size() < 4 || file.substr(file.size()-4) != ".rgs") {
+			return NULL;
+		}
+
+		return CsrGraph::MapSnapshot(file);
+	}
+};
+
+}
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef ALT_PATHING_H_
+#define ALT_PATHING_H_
+
+#include "routing/astar.h"
+#include "impl/csr_graph.h"
+#include <cstdint>
+#include <vector>
+
+namespace routing {
+
+// Distances between every node of a CsrGraph and a few landmark nodes.  By
+// the triangle inequality d(v, t) >= d(L, t) - d(L, v) and
+// d(v, t) >= d(v, L) - d(t, L) for every landmark L, which bounds the
+// distance between any two nodes from below.  Landmarks are picked one at a
+// time as the node farthest from the ones picked so far, so they end up on
+// the edges of the map where the bounds are tightest.
+class Landmarks {
+public:
+	static constexpr uint32_t DefaultCount = 8;
+
+	Landmarks(const CsrGraph& graph, uint32_t count = DefaultCount);
+
+	const CsrGraph& GetGraph() const { return graph; }
+	const std::vector<uint32_t>& GetNodes() const { return nodes; }
+	float LowerBound(uint32_t from, uint32_t to) const;
+
+private:
+	void Distances(uint32_t landmark, bool forward, std::vector<float>& result) const;
+
+	const CsrGraph& graph;
+	std::vector<uint32_t> nodes;
+	// node-major: distance of node v and landmark i is at [v * count + i]
+	std::vector<float> fromLandmark;
+	std::vector<float> toLandmark;
+};
+
+// A* whose heuristic is the better of the euclidean distance and the
+// landmark bound.  The landmark tables are built once for one graph; queries
+// on any other graph use plain A*.
+class ALT : public AStar {
+public:
+	ALT(const CsrGraph& graph, uint32_t landmarks = Landmarks::DefaultCount);
+	virtual ~ALT() {}
+
+	const Landmarks& GetLandmarks() const { return landmarks; }
+
+protected:
+	float LowerBound(const CsrGraph& graph, uint32_t node, uint32_t goal) const;
+	bool HasLowerBound() const { return true; }
+
+private:
+	Landmarks landmarks;
+};
+
+}
+
+#endif
@@ -9,20 +9,38 @@ namespace routing {
 
 class AStar : public RoutingStrategy {
 public:
-	AStar() : cost(new EuclideanDistance()), heuristic(new EuclideanDistance()) {}
-	AStar(DistanceFunction* cost, DistanceFunction* heuristic) : cost(cost), heuristic(heuristic) {}
+	AStar() : cost(new EuclideanDistance()), heuristic(new EuclideanDistance()), name("astar") {}
+	AStar(DistanceFunction* cost, DistanceFunction* heuristic, const std::string& name = "") : cost(cost), heuristic(heuristic), name(name) {}
 	virtual ~AStar();
 
 	std::vector<std::string> GetPath(const IGraph* graph, const std::string& from, const std::string& to) const;
+	std::vector<uint32_t> GetIndexPath(const CsrGraph& graph, uint32_t from, uint32_t to) const;
+	std::string GetName() const { return name; }
 
 	static const RoutingStrategy& Default() {
 		static AStar astar;
 		return astar;
 	}
-	
+
+protected:
+	// Extra lower bound on the distance from node to goal on a CsrGraph.  The
+	// search uses the larger of it and the heuristic, so it must never
+	// overestimate and must be consistent.
+	virtual float LowerBound(const CsrGraph& graph, uint32_t node, uint32_t goal) const { return 0.0f; }
+	// Whether LowerBound is overridden; the search skips it otherwise.
+	virtual bool HasLowerBound() const { return false; }
+
 private:
+	// The search on a CsrGraph, compiled for each combination of cost and
+	// heuristic policy so that the built-in distances are inlined.
+	template <class Cost>
+	std::vector<uint32_t> SearchWith(const CsrGraph& graph, uint32_t from, uint32_t to, const Cost& cost) const;
+	template <class Cost, class Heuristic, bool Bounded>
+	std::vector<uint32_t> Search(const CsrGraph& graph, uint32_t from, uint32_t to, const Cost& cost, const Heuristic& heuristic) const;
+
 	DistanceFunction* cost;
 	DistanceFunction* heuristic;
+	std::string name;
 };
 
 }
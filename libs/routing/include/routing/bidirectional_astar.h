@@ -0,0 +1,39 @@
+#ifndef BIDIRECTIONAL_ASTAR_PATHING_H_
+#define BIDIRECTIONAL_ASTAR_PATHING_H_
+
+#include "routing_strategy.h"
+#include <string>
+
+namespace routing {
+
+// Shortest paths found by searching from both ends of a CsrGraph query at
+// once.  Both searches are guided by half the difference of the euclidean
+// distances to the two ends, which keeps the reduced edge weights consistent
+// in either direction, so the query is over as soon as the smallest keys of
+// the two frontiers add up to the best path seen.  Without the guide it is a
+// bidirectional Dijkstra.  Queries on any other graph run the one-directional
+// search.
+class BidirectionalAStar : public RoutingStrategy {
+public:
+	BidirectionalAStar() : guided(true) {}
+	virtual ~BidirectionalAStar() {}
+
+	std::vector<std::string> GetPath(const IGraph* graph, const std::string& from, const std::string& to) const;
+	std::vector<uint32_t> GetIndexPath(const CsrGraph& graph, uint32_t from, uint32_t to) const;
+	std::string GetName() const { return guided ? "bastar" : "bdijkstra"; }
+
+	static const RoutingStrategy& Default() {
+		static BidirectionalAStar astar;
+		return astar;
+	}
+
+protected:
+	BidirectionalAStar(bool guided) : guided(guided) {}
+
+private:
+	bool guided;
+};
+
+}
+
+#endif
@@ -0,0 +1,21 @@
+#ifndef BIDIRECTIONAL_DIJKSTRA_PATHING_H_
+#define BIDIRECTIONAL_DIJKSTRA_PATHING_H_
+
+#include "routing/bidirectional_astar.h"
+
+namespace routing {
+
+class BidirectionalDijkstra : public BidirectionalAStar {
+public:
+	BidirectionalDijkstra() : BidirectionalAStar(false) {}
+	virtual ~BidirectionalDijkstra() {}
+
+	static const RoutingStrategy& Instance() {
+		static BidirectionalDijkstra dijkstra;
+		return dijkstra;
+	}
+};
+
+}
+
+#endif
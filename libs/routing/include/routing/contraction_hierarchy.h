@@ -0,0 +1,64 @@
+#ifndef CONTRACTION_HIERARCHY_H_
+#define CONTRACTION_HIERARCHY_H_
+
+#include "routing_strategy.h"
+#include "impl/csr_graph.h"
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace routing {
+
+// Shortest paths over a contraction hierarchy of one CsrGraph.  The nodes are
+// contracted once, in order of importance, when the hierarchy is built; a
+// query is then a bidirectional Dijkstra that only climbs towards more
+// important nodes, and the shortcuts it used are unpacked into the original
+// path.  Queries on any other graph fall back to Dijkstra.
+class ContractionHierarchy : public RoutingStrategy {
+public:
+	ContractionHierarchy(const CsrGraph& graph);
+	virtual ~ContractionHierarchy() {}
+
+	std::vector<std::string> GetPath(const IGraph* graph, const std::string& from, const std::string& to) const;
+	std::vector<uint32_t> GetIndexPath(const CsrGraph& graph, uint32_t from, uint32_t to) const;
+	std::string GetName() const { return "ch"; }
+
+	// Every node the upward search from 'node' settles, with its distance,
+	// following upward arcs if 'forward' and downward arcs backwards otherwise.
+	// The distance from s to t is the smallest sum over the nodes the forward
+	// space of s and the backward space of t have in common.
+	std::vector< std::pair<uint32_t, float> > SearchSpace(uint32_t node, bool forward) const;
+
+	const CsrGraph& GetGraph() const { return graph; }
+	uint32_t ShortcutCount() const { return shortcuts; }
+
+private:
+	static constexpr uint32_t NoMiddle = 0xffffffffu;
+
+	// 'node' is the head of an upward arc and the tail of a downward one;
+	// shortcuts remember the node they bypass.
+	struct Arc {
+		uint32_t node;
+		float weight;
+		uint32_t middle;
+	};
+
+	void Contract();
+	const Arc* FindArc(uint32_t from, uint32_t to) const;
+	void Unpack(uint32_t from, uint32_t to, std::vector<uint32_t>& path) const;
+
+	const CsrGraph& graph;
+	std::vector<uint32_t> rank;
+	// up[upOffsets[u]..] are arcs u->v, down[downOffsets[v]..] are arcs u->v,
+	// both only towards the higher ranked endpoint
+	std::vector<uint32_t> upOffsets;
+	std::vector<Arc> up;
+	std::vector<uint32_t> downOffsets;
+	std::vector<Arc> down;
+	uint32_t shortcuts;
+};
+
+}
+
+#endif
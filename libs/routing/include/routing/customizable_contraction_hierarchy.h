@@ -0,0 +1,114 @@
+#ifndef CUSTOMIZABLE_CONTRACTION_HIERARCHY_H_
+#define CUSTOMIZABLE_CONTRACTION_HIERARCHY_H_
+
+#include "routing_strategy.h"
+#include "impl/csr_graph.h"
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace routing {
+
+// Shortest paths over a contraction hierarchy whose edge weights can change
+// while it is in use.  The node order only depends on the topology: the
+// graph is cut into cells by nested dissection of the node positions, every
+// cell is contracted before the separator around it, and all the shortcuts
+// that order could ever need are added once, when the hierarchy is built.
+// Customizing then only computes the weights of the shortcuts, each from the
+// triangles below it, so changing some edges recomputes just the shortcuts
+// above them.
+//
+// A query walks the elimination tree up from both ends, without a priority
+// queue.  Customizing builds a new set of weights, so queries running at the
+// time finish on the old ones.  Queries on any other graph fall back to
+// Dijkstra.
+class CustomizableContractionHierarchy : public RoutingStrategy {
+public:
+	CustomizableContractionHierarchy(const CsrGraph& graph);
+	virtual ~CustomizableContractionHierarchy() {}
+
+	std::vector<std::string> GetPath(const IGraph* graph, const std::string& from, const std::string& to) const;
+	std::vector<uint32_t> GetIndexPath(const CsrGraph& graph, uint32_t from, uint32_t to) const;
+	// "cch" while every edge has the graph's own weight.  Routes found with
+	// other weights are not cached.
+	std::string GetName() const;
+	uint64_t MetricVersion() const;
+
+	struct EdgeUpdate {
+		uint32_t from;
+		uint32_t to;
+		float weight;
+	};
+
+	// Replaces the weight of every edge, indexed like the edges of the graph,
+	// and customizes the whole hierarchy.  An infinite weight closes the edge.
+	void SetEdgeWeights(const std::vector<float>& weights);
+	// Gives the edges from -> to new weights and recustomizes the shortcuts
+	// that depend on them.  Throws std::invalid_argument, changing nothing, if
+	// one of the edges is not in the graph.
+	void UpdateEdges(const std::vector<EdgeUpdate>& updates);
+	void UpdateEdge(uint32_t from, uint32_t to, float weight) { UpdateEdges({EdgeUpdate{from, to, weight}}); }
+	// Back to the weights of the graph.
+	void ResetEdgeWeights();
+	// The weight the edge has now.
+	float EdgeWeight(uint32_t edge) const;
+
+	const CsrGraph& GetGraph() const { return graph; }
+	uint32_t ArcCount() const { return static_cast<uint32_t>(heads.size()); }
+
+private:
+	static constexpr uint32_t NoMiddle = 0xffffffffu;
+
+	// Weights of one customization.  Arc a runs between tails[a] and the
+	// higher ranked heads[a]; up is the weight from tail to head, down the
+	// weight back, and the middles are the nodes a shortcut bypasses.
+	struct Metric {
+		uint64_t version;
+		// edges whose weight is not the graph's own
+		uint32_t changed;
+		std::vector<float> edges;
+		std::vector<float> up;
+		std::vector<float> down;
+		std::vector<uint32_t> upMiddle;
+		std::vector<uint32_t> downMiddle;
+	};
+
+	void Dissect();
+	void Contract();
+	uint32_t FindArc(uint32_t low, uint32_t high) const;
+	// Recomputes arc a from the graph's edges and the triangles below it,
+	// returning whether its weights changed.
+	bool Customize(Metric& metric, uint32_t a) const;
+	void CustomizeAll(Metric& metric) const;
+	std::shared_ptr<const Metric> GetMetric() const;
+	void Publish(std::shared_ptr<const Metric> next);
+	void Unpack(const Metric& metric, uint32_t from, uint32_t to, std::vector<uint32_t>& path) const;
+
+	const CsrGraph& graph;
+	// nodes from the lowest rank to the highest
+	std::vector<uint32_t> order;
+	std::vector<uint32_t> rank;
+	// lowest ranked upper neighbour, the parent in the elimination tree
+	std::vector<uint32_t> parent;
+	// arcs of node u are arcOffsets[u] .. arcOffsets[u+1]-1, sorted by head
+	std::vector<uint32_t> arcOffsets;
+	std::vector<uint32_t> tails;
+	std::vector<uint32_t> heads;
+	// arcs into node v from lower ranked nodes, sorted by tail, to find the
+	// triangles below an arc
+	std::vector<uint32_t> lowerOffsets;
+	std::vector<uint32_t> lowerArcs;
+	// the arc each edge of the graph lies on
+	std::vector<uint32_t> edgeArcs;
+
+	mutable std::mutex metricMutex;
+	std::shared_ptr<const Metric> metric;
+	// customizations are made one at a time
+	std::mutex customizeMutex;
+};
+
+}
+
+#endif
@@ -11,6 +11,8 @@ public:
 	virtual ~DepthFirstSearch() {}
 
 	std::vector<std::string> GetPath(const IGraph* graph, const std::string& from, const std::string& to) const;
+	std::vector<uint32_t> GetIndexPath(const CsrGraph& graph, uint32_t from, uint32_t to) const;
+	std::string GetName() const { return "dfs"; }
 
 	static const RoutingStrategy& Default() {
 		static DepthFirstSearch dfs;
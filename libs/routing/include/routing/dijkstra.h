@@ -8,7 +8,7 @@ namespace routing {
 
 class Dijkstra : public AStar {
 public:
-    Dijkstra() : AStar(new EuclideanDistance(), new ZeroDistance()) {}
+    Dijkstra() : AStar(new EuclideanDistance(), new ZeroDistance(), "dijkstra") {}
 	virtual ~Dijkstra() {}
 
 	static const RoutingStrategy& Instance() {
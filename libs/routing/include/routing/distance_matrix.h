@@ -0,0 +1,51 @@
+#ifndef DISTANCE_MATRIX_H_
+#define DISTANCE_MATRIX_H_
+
+#include "graph.h"
+#include "routing/contraction_hierarchy.h"
+#include "impl/csr_graph.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace routing {
+
+// Road distances from each of N source points to each of M target points,
+// the points snapped to their nearest nodes like GetPath does.  Given a
+// contraction hierarchy of the graph the searches are shared: every target's
+// backward search space is left in buckets at the nodes it settles, and each
+// source only runs its forward search, reading the buckets of the nodes it
+// settles.  Otherwise each source runs one Dijkstra that stops once all
+// targets are settled.  Both run on GetRoutingGraph() of the graph, so the
+// hierarchy must be one of that graph.  The searches are spread over
+// 'threads' threads.
+class DistanceMatrix {
+public:
+	DistanceMatrix(const IGraph& graph, const std::vector< std::vector<float> >& sources,
+	               const std::vector< std::vector<float> >& targets,
+	               const ContractionHierarchy* hierarchy = NULL, unsigned threads = 1);
+
+	size_t Rows() const { return sources.size(); }
+	size_t Columns() const { return targets.size(); }
+	// infinity if the target cannot be reached from the source
+	float Distance(size_t source, size_t target) const { return distances[source * targets.size() + target]; }
+	// row-major, one row per source
+	const std::vector<float>& GetDistances() const { return distances; }
+	// The route behind one entry, searched on demand.
+	std::vector< std::vector<float> > GetPath(size_t source, size_t target) const;
+
+private:
+	void FromHierarchy(const ContractionHierarchy& hierarchy, unsigned threads);
+	void FromCsrGraph(const CsrGraph& graph, unsigned threads);
+	void FromGraph(unsigned threads);
+
+	const IGraph& graph;
+	const ContractionHierarchy* hierarchy;
+	std::vector< std::vector<float> > sources;
+	std::vector< std::vector<float> > targets;
+	std::vector<float> distances;
+};
+
+}
+
+#endif
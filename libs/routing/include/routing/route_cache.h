@@ -0,0 +1,83 @@
+#ifndef ROUTE_CACHE_H_
+#define ROUTE_CACHE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace routing {
+
+// Least recently used cache of routes, keyed by the strategy name and the
+// 64-bit ids of the snapped start and end nodes (see CsrGraph::IdOf).  Paths
+// are stored once and shared, read-only, by every caller that finds them.
+// All members are safe to call from several threads at once.
+//
+// A cache belongs to one graph: the nodes are only identified by id, so a
+// file written by Save records the graph's CsrGraph::Fingerprint and Load
+// refuses it for any other graph.
+class RouteCache {
+public:
+	typedef std::vector< std::vector<float> > Path;
+
+	explicit RouteCache(size_t capacity);
+
+	// NULL, and a miss counted, if the route is not cached.
+	std::shared_ptr<const Path> Find(const std::string& strategy, uint64_t from, uint64_t to);
+	// Adds or replaces a route, evicting the least recently used one when full.
+	void Insert(const std::string& strategy, uint64_t from, uint64_t to, std::shared_ptr<const Path> path);
+	void Clear();
+
+	size_t Size() const;
+	size_t Capacity() const { return capacity; }
+	uint64_t Hits() const { return hits; }
+	uint64_t Misses() const { return misses; }
+
+	// Writes the routes, found on the graph with the given fingerprint,
+	// throwing std::runtime_error if the file cannot be written.  Strategy
+	// names must not contain whitespace.
+	void Save(const std::string& file, uint64_t graph) const;
+	// Adds the routes of a file written by Save, throwing std::runtime_error if
+	// it cannot be read, is not a route cache or was saved for another graph.
+	void Load(const std::string& file, uint64_t graph);
+
+private:
+	// the strategy is its position in 'strategies'
+	struct Key {
+		uint32_t strategy;
+		uint64_t from;
+		uint64_t to;
+		bool operator==(const Key& other) const {
+			return strategy == other.strategy && from == other.from && to == other.to;
+		}
+	};
+	struct KeyHash {
+		size_t operator()(const Key& key) const;
+	};
+	struct Entry {
+		Key key;
+		std::shared_ptr<const Path> path;
+	};
+	typedef std::list<Entry> Entries;
+
+	// Must be called with the mutex held.
+	uint32_t StrategyIndex(const std::string& strategy);
+
+	const size_t capacity;
+	mutable std::mutex mutex;
+	// most recently used first
+	Entries entries;
+	std::unordered_map<Key, Entries::iterator, KeyHash> index;
+	// the few strategy names seen so far, so that keys hold no strings
+	std::vector<std::string> strategies;
+	std::atomic<uint64_t> hits;
+	std::atomic<uint64_t> misses;
+};
+
+}
+
+#endif
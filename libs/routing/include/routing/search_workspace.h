@@ -0,0 +1,78 @@
+#ifndef SEARCH_WORKSPACE_H_
+#define SEARCH_WORKSPACE_H_
+
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace routing {
+
+// Per-node search state shared by the integer searches.  Instead of clearing
+// the arrays for every query each slot is stamped with the generation of the
+// query that wrote it, so starting a new search is O(1) and the storage is
+// reused from query to query.
+class SearchWorkspace {
+public:
+	typedef std::pair<float, uint32_t> HeapEntry;
+
+	static constexpr uint32_t NoParent = 0xffffffffu;
+
+	// Starts a new query over a graph of the given size.
+	void Reset(uint32_t nodeCount);
+
+	bool Reached(uint32_t node) const { return reached[node] == generation; }
+	bool Closed(uint32_t node) const { return closed[node] == generation; }
+	float Distance(uint32_t node) const {
+		return Reached(node) ? distance[node] : std::numeric_limits<float>::infinity();
+	}
+	uint32_t Parent(uint32_t node) const { return parent[node]; }
+
+	void Reach(uint32_t node, float dist, uint32_t from) {
+		reached[node] = generation;
+		distance[node] = dist;
+		parent[node] = from;
+	}
+	void Close(uint32_t node) { closed[node] = generation; }
+
+	// Min-heap on the first element, backed by reusable storage.
+	bool HeapEmpty() const { return heap.empty(); }
+	const HeapEntry& HeapTop() const { return heap.front(); }
+	void HeapPush(float key, uint32_t node);
+	HeapEntry HeapPop();
+
+	// FIFO/LIFO frontier for the unweighted searches.
+	std::vector<uint32_t>& Frontier() { return frontier; }
+
+	// Path from the root of the search tree to 'last'.
+	std::vector<uint32_t> Unwind(uint32_t last) const;
+
+	// Hands out one of the calling thread's workspaces for the duration of a
+	// query.  Nested or bidirectional searches lease one workspace each; the
+	// thread keeps them around for its next queries.
+	class Lease {
+	public:
+		Lease();
+		~Lease();
+		SearchWorkspace& operator*() const { return *workspace; }
+		SearchWorkspace* operator->() const { return workspace; }
+	private:
+		Lease(const Lease&);
+		Lease& operator=(const Lease&);
+		SearchWorkspace* workspace;
+	};
+
+private:
+	uint32_t generation = 0;
+	bool inUse = false;
+	std::vector<uint32_t> reached;
+	std::vector<uint32_t> closed;
+	std::vector<float> distance;
+	std::vector<uint32_t> parent;
+	std::vector<HeapEntry> heap;
+	std::vector<uint32_t> frontier;
+};
+
+}
+
+#endif
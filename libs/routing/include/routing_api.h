@@ -9,10 +9,19 @@ namespace routing {
 
 class RoutingAPI {
 public:
-    RoutingAPI();
+    // OSM maps are parsed by 'importThreads' threads at once.
+    explicit RoutingAPI(unsigned importThreads = 1);
 	virtual ~RoutingAPI();
     virtual IGraph* LoadFromFile(const std::string& file) const;
     virtual void AddFactory(const IGraphFactory* factory);
+    // Writes the graph as a binary snapshot (.rgs) that LoadFromFile maps
+    // without parsing.  The snapshot remembers the size and modification time
+    // of source, the map it was loaded from, if one is given.
+    virtual void SaveSnapshot(const IGraph* graph, const std::string& file, const std::string& source = "") const;
+    // Loads a map through the snapshot next to it (same name, .rgs), parsing
+    // the map and writing the snapshot only if there is no usable one.  A
+    // snapshot written before the map last changed is not usable.
+    virtual IGraph* LoadWithSnapshot(const std::string& file) const;
 
 private:
     std::vector<const IGraphFactory*> factories;
@@ -1,6 +1,8 @@
 #ifndef ROUTING_STRATEGY_H_
 #define ROUTING_STRATEGY_H_
 
+#include <atomic>
+#include <cstdint>
 #include <vector>
 #include <string>
 #include "graph.h"
@@ -8,11 +10,29 @@
 namespace routing {
 
 class IGraph;
+class CsrGraph;
 
 class RoutingStrategy {
 public:
 	virtual ~RoutingStrategy() {}
 	virtual std::vector<std::string> GetPath(const IGraph* graph, const std::string& from, const std::string& to) const = 0;
+	// Same as GetPath, but over the integer node ids of a CsrGraph.  The default
+	// goes through the node names so that every strategy works on a CsrGraph.
+	virtual std::vector<uint32_t> GetIndexPath(const CsrGraph& graph, uint32_t from, uint32_t to) const;
+	// Identifies the strategy in a RouteCache; two strategies with the same
+	// name must find the same paths.  Unnamed strategies are never cached.
+	virtual std::string GetName() const { return ""; }
+	// Changes whenever the edge weights the strategy searches with change, so
+	// that routes found before can be planned again.  Fixed weights stay 0.
+	virtual uint64_t MetricVersion() const { return 0; }
+	// Nodes settled by all queries so far, for comparing the weighted searches.
+	uint64_t SettledNodes() const { return settled; }
+
+protected:
+	void CountSettled(uint64_t nodes) const { settled += nodes; }
+
+private:
+	mutable std::atomic<uint64_t> settled{0};
 };
 
 }
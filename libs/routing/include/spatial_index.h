@@ -0,0 +1,49 @@
+#ifndef SPATIAL_INDEX_H_
+#define SPATIAL_INDEX_H_
+
+#include <cstdint>
+#include <vector>
+
+namespace routing {
+
+// Static 3d k-d tree over a set of points, answering euclidean nearest
+// neighbour, k-nearest and radius queries in logarithmic time.  Results are
+// the indices of the points in the order they were given to the constructor;
+// ties are broken towards the lower index, as a linear scan would.
+class SpatialIndex {
+public:
+	static constexpr uint32_t NotFound = 0xffffffffu;
+
+	// 'positions' holds x, y, z for each point, packed one after the other.
+	SpatialIndex(const float* positions, uint32_t count);
+
+	uint32_t Size() const { return static_cast<uint32_t>(ids.size()); }
+
+	uint32_t Nearest(const float point[3]) const;
+	std::vector<uint32_t> Nearest(const std::vector<float>& points) const;
+	std::vector<uint32_t> KNearest(const float point[3], uint32_t k) const;
+	std::vector<uint32_t> Within(const float point[3], float radius) const;
+
+private:
+	struct Candidate {
+		float distance;
+		uint32_t id;
+		bool operator<(const Candidate& other) const {
+			return distance < other.distance || (distance == other.distance && id < other.id);
+		}
+	};
+
+	void Build(uint32_t lo, uint32_t hi);
+	float DistanceSquared(uint32_t slot, const float point[3]) const;
+	void Search(uint32_t lo, uint32_t hi, const float point[3], uint32_t k, std::vector<Candidate>& best) const;
+	void Collect(uint32_t lo, uint32_t hi, const float point[3], float radius2, std::vector<Candidate>& found) const;
+
+	// the points in tree order, slot (lo+hi)/2 splits the range [lo, hi)
+	std::vector<float> coords;
+	std::vector<uint32_t> ids;
+	std::vector<uint8_t> axes;
+};
+
+}
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef PARALLEL_FOR_H_
+#define PARALLEL_FOR_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace routing {
+
+// Calls work(i) for every i below count on up to 'threads' threads, the
+// calling one included, handing the next i to whichever thread is free first.
+// The first exception thrown by work is rethrown once every thread is done;
+// no further work is started after it.
+template <class Work>
+void ParallelFor(size_t count, unsigned threads, const Work& work) {
+	std::atomic<size_t> next(0);
+	std::mutex failureMutex;
+	std::exception_ptr failure;
+	auto run = [&]() {
+		for (size_t i = next++; i < count; i = next++) {
+			try {
+				work(i);
+			}
+			catch (...) {
+				std::lock_guard<std::mutex> lock(failureMutex);
+				if (!failure) {
+					failure = std::current_exception();
+				}
+				next = count;
+			}
+		}
+	};
+
+	threads = static_cast<unsigned>(std::max<size_t>(1, std::min<size_t>(threads, count)));
+	std::vector<std::thread> helpers;
+	for (unsigned t = 1; t < threads; t++) {
+		helpers.emplace_back(run);
+	}
+	run();
+	for (std::thread& helper : helpers) {
+		helper.join();
+	}
+	if (failure) {
+		std::rethrow_exception(failure);
+	}
+}
+
+}
+
+#endif
@@ -1,5 +1,9 @@
 #include "graph.h"
+#include "impl/csr_graph.h"
+#include "routing/route_cache.h"
+#include <algorithm>
 #include <limits>
+#include <typeinfo>
 
 namespace routing {
 
@@ -7,35 +11,69 @@ BoundingBox GraphBase::GetBoundingBox() const {
     BoundingBox bb;
 
     const std::vector<IGraphNode*>& nodes = GetNodes();
-    
-    for (int i = 0; i < nodes.size(); i++) {
-        std::vector<float> pos = nodes[i]->GetPosition();
-        if (i == 0) {
-            bb.min = pos;
-            bb.max = pos;
-        }
-        else {
-            for (int j = 0; j < pos.size(); j++) {
-                if (bb.min[j] > pos[j]) {
-                    bb.min[j] = pos[j];
-                }
-                if (bb.max[j] < pos[j]) {
-                    bb.max[j] = pos[j];
-                }
-            }
-        }
+    if (nodes.empty()) {
+        return bb;
+    }
+
+    Float3 min = nodes[0]->GetPoint();
+    Float3 max = min;
+    for (int i = 1; i < nodes.size(); i++) {
+        const Float3 pos = nodes[i]->GetPoint();
+        min = Float3(std::min(min.x, pos.x), std::min(min.y, pos.y), std::min(min.z, pos.z));
+        max = Float3(std::max(max.x, pos.x), std::max(max.y, pos.y), std::max(max.z, pos.z));
     }
 
+    bb.min = min.ToVector();
+    bb.max = max.ToVector();
     return bb;
 }
 
+GraphBase::~GraphBase() {
+    delete spatialIndex;
+    delete routingGraph;
+}
+
+SpatialIndex* GraphBase::BuildSpatialIndex() const {
+    const std::vector<IGraphNode*>& nodes = GetNodes();
+    std::vector<float> positions;
+    positions.reserve(3 * nodes.size());
+    for (auto* node : nodes) {
+        const Float3 pos = node->GetPoint();
+        positions.push_back(pos.x);
+        positions.push_back(pos.y);
+        positions.push_back(pos.z);
+    }
+    return new SpatialIndex(positions.data(), nodes.size());
+}
+
+const SpatialIndex& GraphBase::GetSpatialIndex() const {
+    std::call_once(spatialIndexBuilt, [this]() { spatialIndex = BuildSpatialIndex(); });
+    return *spatialIndex;
+}
+
+std::vector<const IGraphNode*> GraphBase::ToNodes(const std::vector<uint32_t>& ids) const {
+    const std::vector<IGraphNode*>& nodes = GetNodes();
+    std::vector<const IGraphNode*> result;
+    result.reserve(ids.size());
+    for (uint32_t id : ids) {
+        result.push_back(id == SpatialIndex::NotFound ? NULL : nodes[id]);
+    }
+    return result;
+}
+
 const IGraphNode* GraphBase::NearestNode(std::vector<float> point, const DistanceFunction& distanceFunction) const {
-    const std::vector<IGraphNode*> nodes = GetNodes();
+    if (typeid(distanceFunction) == typeid(EuclideanDistance)) {
+        point.resize(3, 0.0f);
+        uint32_t id = GetSpatialIndex().Nearest(point.data());
+        return id == SpatialIndex::NotFound ? NULL : GetNodes()[id];
+    }
+
+    const std::vector<IGraphNode*>& nodes = GetNodes();
+    const Float3 target(point);
     float minDistance = std::numeric_limits<float>::infinity();
     const IGraphNode* closestNode = NULL;
     for (auto* node: nodes) {
-        auto temp_3d = node->GetPosition();
-        float distance = distanceFunction.Calculate(temp_3d, point);
+        float distance = distanceFunction.Between(node->GetPoint(), target);
         if (distance < minDistance) {
             closestNode = node;
             minDistance = distance;
@@ -45,22 +83,81 @@ const IGraphNode* GraphBase::NearestNode(std::vector<float> point, const Distanc
     return closestNode;
 }
 
-const std::vector< std::vector<float> > GraphBase::GetPath(std::vector<float> src, std::vector<float> dest, const RoutingStrategy& pathing) const {
-    using namespace std;
-    const IGraphNode* start_node = NearestNode(src, EuclideanDistance());
-    const IGraphNode* end_node = NearestNode(dest, EuclideanDistance());
+std::vector<const IGraphNode*> GraphBase::NearestNodes(const std::vector< std::vector<float> >& points) const {
+    std::vector<float> packed;
+    packed.reserve(3 * points.size());
+    for (const std::vector<float>& point : points) {
+        for (int j = 0; j < 3; j++) {
+            packed.push_back(j < point.size() ? point[j] : 0.0f);
+        }
+    }
+    return ToNodes(GetSpatialIndex().Nearest(packed));
+}
+
+std::vector<const IGraphNode*> GraphBase::KNearestNodes(std::vector<float> point, uint32_t k) const {
+    point.resize(3, 0.0f);
+    return ToNodes(GetSpatialIndex().KNearest(point.data(), k));
+}
+
+std::vector<const IGraphNode*> GraphBase::NodesWithin(std::vector<float> point, float radius) const {
+    point.resize(3, 0.0f);
+    return ToNodes(GetSpatialIndex().Within(point.data(), radius));
+}
 
-    vector<string> string_path = pathing.GetPath(this, start_node->GetName(), end_node->GetName());
+const CsrGraph& GraphBase::GetRoutingGraph() const {
+    std::call_once(routingGraphBuilt, [this]() { routingGraph = new CsrGraph(*this, CsrGraph::SourceOrder); });
+    return *routingGraph;
+}
 
-    vector< vector<float> > position_path;
-    position_path.push_back(start_node->GetPosition());
-    for (int i = 0; i < string_path.size(); i++) {
-        position_path.push_back(this->GetNode(string_path[i])->GetPosition());
+bool GraphBase::SnapEnds(std::vector<float> src, std::vector<float> dest, uint32_t& start, uint32_t& end) const {
+    src.resize(3, 0.0f);
+    dest.resize(3, 0.0f);
+    start = GetSpatialIndex().Nearest(src.data());
+    end = GetSpatialIndex().Nearest(dest.data());
+    return start != SpatialIndex::NotFound && end != SpatialIndex::NotFound;
+}
+
+std::vector<uint32_t> GraphBase::GetIndexPath(std::vector<float> src, std::vector<float> dest, const RoutingStrategy& pathing) const {
+    uint32_t start_node, end_node;
+    if (!SnapEnds(src, dest, start_node, end_node)) {
+        return {};
     }
-    position_path.push_back(end_node->GetPosition());
 
-    return position_path; 
+    std::vector<uint32_t> index_path = pathing.GetIndexPath(GetRoutingGraph(), start_node, end_node);
+    index_path.insert(index_path.begin(), start_node);
+    index_path.push_back(end_node);
+    return index_path;
 }
 
+const std::vector< std::vector<float> > GraphBase::GetPath(std::vector<float> src, std::vector<float> dest, const RoutingStrategy& pathing) const {
+    uint32_t start_node, end_node;
+    if (!SnapEnds(src, dest, start_node, end_node)) {
+        return {};
+    }
+
+    const CsrGraph& graph = GetRoutingGraph();
+    std::string cached = routeCache ? pathing.GetName() : "";
+    if (!cached.empty()) {
+        std::shared_ptr<const RouteCache::Path> hit = routeCache->Find(cached, graph.IdOf(start_node), graph.IdOf(end_node));
+        if (hit) {
+            return *hit;
+        }
+    }
+
+    std::vector<uint32_t> index_path = pathing.GetIndexPath(graph, start_node, end_node);
+
+    std::vector< std::vector<float> > position_path;
+    position_path.reserve(index_path.size() + 2);
+    position_path.emplace_back(graph.Position(start_node), graph.Position(start_node) + 3);
+    for (uint32_t node : index_path) {
+        position_path.emplace_back(graph.Position(node), graph.Position(node) + 3);
+    }
+    position_path.emplace_back(graph.Position(end_node), graph.Position(end_node) + 3);
+
+    if (!cached.empty()) {
+        routeCache->Insert(cached, graph.IdOf(start_node), graph.IdOf(end_node), std::make_shared<const RouteCache::Path>(position_path));
+    }
+    return position_path;
 }
 
+}
@@ -0,0 +1,522 @@
+#include "impl/csr_graph.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <typeinfo>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace routing {
+
+const std::string& CsrGraphNode::GetName() const {
+    return graph->NameOf(index);
+}
+
+const std::vector<float> CsrGraphNode::GetPosition() const {
+    const float* p = graph->Position(index);
+    return std::vector<float>(p, p + 3);
+}
+
+Float3 CsrGraphNode::GetPoint() const {
+    return Float3(graph->Position(index));
+}
+
+namespace {
+
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t nodeCount;
+    uint32_t edgeCount;
+    float min[3];
+    float max[3];
+    // size and modification time of the file the graph was loaded from, or
+    // 0 if it was not recorded
+    uint64_t sourceSize;
+    int64_t sourceModified;
+    // byte offsets of the arrays from the start of the file
+    uint64_t offsets;
+    uint64_t targets;
+    uint64_t weights;
+    uint64_t positions;
+    uint64_t ids;
+    uint64_t order;
+    uint64_t size;
+};
+
+const char SnapshotMagic[8] = {'R', 'G', 'S', 'N', 'A', 'P', '\0', '\0'};
+const uint32_t ByteOrderMark = 0x01020304;
+
+// Size and modification time in nanoseconds of a file, false if it cannot be
+// read.
+bool sourceStamp(const std::string& file, uint64_t* size, int64_t* modified) {
+    struct stat info;
+    if (file.empty() || stat(file.c_str(), &info) != 0) {
+        return false;
+    }
+    *size = static_cast<uint64_t>(info.st_size);
+    *modified = static_cast<int64_t>(info.st_mtim.tv_sec) * 1000000000 + info.st_mtim.tv_nsec;
+    return true;
+}
+
+uint64_t align8(uint64_t offset) {
+    return (offset + 7) & ~static_cast<uint64_t>(7);
+}
+
+// Names such as "007" would not survive the round trip through an integer.
+bool parseId(const std::string& name, uint64_t* id) {
+    if (name.empty() || name.size() > 20) {
+        return false;
+    }
+    for (char c : name) {
+        if (c < '0' || c > '9') {
+            return false;
+        }
+    }
+    *id = std::strtoull(name.c_str(), NULL, 10);
+    return std::to_string(*id) == name;
+}
+
+// FNV-1a over a block of memory, continuing from hash.
+uint64_t fnv1a(uint64_t hash, const void* data, size_t bytes) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < bytes; i++) {
+        hash = (hash ^ p[i]) * 0x100000001b3ull;
+    }
+    return hash;
+}
+
+// Distance of (x, y) along a Hilbert curve filling a 65536 x 65536 grid.
+uint64_t hilbertIndex(uint32_t x, uint32_t y) {
+    const uint32_t n = 1u << 16;
+    uint64_t d = 0;
+    for (uint32_t s = n / 2; s > 0; s /= 2) {
+        const uint32_t rx = (x & s) ? 1 : 0;
+        const uint32_t ry = (y & s) ? 1 : 0;
+        d += static_cast<uint64_t>(s) * s * ((3 * rx) ^ ry);
+        if (ry == 0) {
+            if (rx == 1) {
+                x = n - 1 - x;
+                y = n - 1 - y;
+            }
+            std::swap(x, y);
+        }
+    }
+    return d;
+}
+
+// Source indices of the nodes in Hilbert order of their positions, projected
+// onto the two axes along which the graph is widest.
+std::vector<uint32_t> hilbertOrder(const std::vector<float>& positions) {
+    const uint32_t count = static_cast<uint32_t>(positions.size() / 3);
+    float min[3] = {0, 0, 0};
+    float max[3] = {0, 0, 0};
+    for (uint32_t i = 0; i < count; i++) {
+        for (int j = 0; j < 3; j++) {
+            const float value = positions[3 * i + j];
+            min[j] = i == 0 ? value : std::min(min[j], value);
+            max[j] = i == 0 ? value : std::max(max[j], value);
+        }
+    }
+    int axes[3] = {0, 1, 2};
+    std::sort(axes, axes + 3, [&](int a, int b) { return max[a] - min[a] > max[b] - min[b]; });
+
+    std::vector<std::pair<uint64_t, uint32_t> > keys(count);
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t cell[2];
+        for (int k = 0; k < 2; k++) {
+            const int j = axes[k];
+            const float extent = max[j] - min[j];
+            const float t = extent > 0 ? (positions[3 * i + j] - min[j]) / extent : 0.0f;
+            cell[k] = std::min<uint32_t>(65535, static_cast<uint32_t>(t * 65536.0f));
+        }
+        keys[i] = std::make_pair(hilbertIndex(cell[0], cell[1]), i);
+    }
+    std::sort(keys.begin(), keys.end());
+
+    std::vector<uint32_t> order(count);
+    for (uint32_t i = 0; i < count; i++) {
+        order[i] = keys[i].second;
+    }
+    return order;
+}
+
+}
+
+CsrGraph::CsrGraph() : nodeCount(0), edgeCount(0), offsets(NULL), targets(NULL), weights(NULL),
+    positions(NULL), ids(NULL), order(NULL), mapping(NULL), mappingSize(0) {}
+
+CsrGraph::CsrGraph(const IGraph& graph, NodeOrder nodeOrder) : CsrGraph() {
+    const std::vector<IGraphNode*>& nodes = graph.GetNodes();
+    nodeCount = static_cast<uint32_t>(nodes.size());
+
+    std::vector<float> sourcePositions;
+    sourcePositions.reserve(3 * nodeCount);
+    for (uint32_t i = 0; i < nodeCount; i++) {
+        const Float3 pos = nodes[i]->GetPoint();
+        sourcePositions.push_back(pos.x);
+        sourcePositions.push_back(pos.y);
+        sourcePositions.push_back(pos.z);
+    }
+
+    // ownedOrder maps the new indices to the source ones, index the reverse
+    if (nodeOrder == HilbertOrder) {
+        ownedOrder = hilbertOrder(sourcePositions);
+    } else {
+        ownedOrder.resize(nodeCount);
+        for (uint32_t i = 0; i < nodeCount; i++) {
+            ownedOrder[i] = i;
+        }
+    }
+    std::unordered_map<const IGraphNode*, uint32_t> index;
+    index.reserve(nodeCount);
+    for (uint32_t i = 0; i < nodeCount; i++) {
+        index[nodes[ownedOrder[i]]] = i;
+    }
+
+    names.reserve(nodeCount);
+    ownedIds.reserve(nodeCount);
+    ownedPositions.reserve(3 * nodeCount);
+    bool numeric = true;
+    for (uint32_t i = 0; i < nodeCount; i++) {
+        const uint32_t source = ownedOrder[i];
+        names.push_back(nodes[source]->GetName());
+
+        uint64_t id = 0;
+        numeric = numeric && parseId(names.back(), &id);
+        ownedIds.push_back(id);
+        ownedPositions.insert(ownedPositions.end(), &sourcePositions[3 * source], &sourcePositions[3 * source] + 3);
+    }
+    if (!numeric) {
+        ownedIds.clear();
+    }
+    std::vector<float>().swap(sourcePositions);
+
+    ownedOffsets.reserve(nodeCount + 1);
+    ownedOffsets.push_back(0);
+    for (uint32_t i = 0; i < nodeCount; i++) {
+        const uint32_t begin = static_cast<uint32_t>(ownedTargets.size());
+        for (const WeightedNeighbor& edge : nodes[ownedOrder[i]]->WeightedNeighbors()) {
+            auto it = index.find(edge.node);
+            if (it == index.end()) {
+                throw std::invalid_argument("neighbor not in graph: " + edge.node->GetName());
+            }
+
+            // parsers such as ObjGraph add the same edge once per face
+            bool duplicate = false;
+            for (uint32_t e = begin; e < ownedTargets.size(); e++) {
+                if (ownedTargets[e] == it->second) {
+                    duplicate = true;
+                    break;
+                }
+            }
+            if (duplicate) {
+                continue;
+            }
+
+            ownedTargets.push_back(it->second);
+            ownedWeights.push_back(edge.weight);
+        }
+        ownedOffsets.push_back(static_cast<uint32_t>(ownedTargets.size()));
+    }
+
+    edgeCount = static_cast<uint32_t>(ownedTargets.size());
+    offsets = ownedOffsets.data();
+    targets = ownedTargets.data();
+    weights = ownedWeights.data();
+    positions = ownedPositions.data();
+    ids = numeric ? ownedIds.data() : NULL;
+    order = ownedOrder.data();
+
+    if (nodeCount > 0) {
+        bounds.min.assign(Position(0), Position(0) + 3);
+        bounds.max.assign(Position(0), Position(0) + 3);
+        for (uint32_t i = 1; i < nodeCount; i++) {
+            const float* pos = Position(i);
+            for (int j = 0; j < 3; j++) {
+                if (bounds.min[j] > pos[j]) {
+                    bounds.min[j] = pos[j];
+                }
+                if (bounds.max[j] < pos[j]) {
+                    bounds.max[j] = pos[j];
+                }
+            }
+        }
+    }
+}
+
+CsrGraph::~CsrGraph() {
+    for (int i = 0; i < views.size(); i++) {
+        delete views[i];
+    }
+    if (mapping) {
+        munmap(mapping, mappingSize);
+    }
+}
+
+CsrGraph* CsrGraph::MapSnapshot(const std::string& file, const std::string& source) {
+    int fd = open(file.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("cannot open graph snapshot: " + file);
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(SnapshotHeader))) {
+        close(fd);
+        throw std::runtime_error("truncated graph snapshot: " + file);
+    }
+    const size_t size = static_cast<size_t>(info.st_size);
+    void* data = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        throw std::runtime_error("cannot map graph snapshot: " + file);
+    }
+
+    const char* base = static_cast<const char*>(data);
+    const SnapshotHeader* header = reinterpret_cast<const SnapshotHeader*>(base);
+    const uint64_t n = header->nodeCount;
+    const uint64_t m = header->edgeCount;
+    uint64_t sourceSize = 0;
+    int64_t sourceModified = 0;
+    std::string problem;
+    if (std::memcmp(header->magic, SnapshotMagic, sizeof(SnapshotMagic)) != 0) {
+        problem = "not a graph snapshot";
+    } else if (header->byteOrder != ByteOrderMark) {
+        problem = "snapshot written with another byte order";
+    } else if (header->version != SnapshotVersion) {
+        problem = "unsupported snapshot version " + std::to_string(header->version);
+    } else if (sourceStamp(source, &sourceSize, &sourceModified)
+            && (header->sourceSize != sourceSize || header->sourceModified != sourceModified)) {
+        problem = "graph snapshot out of date with " + source;
+    } else if (header->size != size
+            || header->offsets + 4 * (n + 1) > size || header->targets + 4 * m > size
+            || header->weights + 4 * m > size || header->positions + 12 * n > size
+            || header->ids + 8 * n > size || header->order + 4 * n > size) {
+        problem = "truncated graph snapshot";
+    } else {
+        // a corrupt snapshot would otherwise send the searches out of bounds
+        const uint32_t* offsets = reinterpret_cast<const uint32_t*>(base + header->offsets);
+        const uint32_t* targets = reinterpret_cast<const uint32_t*>(base + header->targets);
+        bool consistent = offsets[0] == 0 && offsets[n] == m;
+        for (uint64_t i = 0; consistent && i < n; i++) {
+            consistent = offsets[i] <= offsets[i + 1];
+        }
+        for (uint64_t e = 0; consistent && e < m; e++) {
+            consistent = targets[e] < n;
+        }
+        const uint32_t* order = reinterpret_cast<const uint32_t*>(base + header->order);
+        for (uint64_t i = 0; consistent && i < n; i++) {
+            consistent = order[i] < n;
+        }
+        if (!consistent) {
+            problem = "inconsistent graph snapshot";
+        }
+    }
+    if (!problem.empty()) {
+        munmap(data, size);
+        throw std::runtime_error(problem + ": " + file);
+    }
+
+    CsrGraph* graph = new CsrGraph();
+    graph->mapping = data;
+    graph->mappingSize = size;
+    graph->nodeCount = header->nodeCount;
+    graph->edgeCount = header->edgeCount;
+    graph->offsets = reinterpret_cast<const uint32_t*>(base + header->offsets);
+    graph->targets = reinterpret_cast<const uint32_t*>(base + header->targets);
+    graph->weights = reinterpret_cast<const float*>(base + header->weights);
+    graph->positions = reinterpret_cast<const float*>(base + header->positions);
+    graph->ids = reinterpret_cast<const uint64_t*>(base + header->ids);
+    graph->order = reinterpret_cast<const uint32_t*>(base + header->order);
+    if (n > 0) {
+        graph->bounds.min.assign(header->min, header->min + 3);
+        graph->bounds.max.assign(header->max, header->max + 3);
+    }
+    return graph;
+}
+
+void CsrGraph::WriteSnapshot(const std::string& file, const std::string& source) const {
+    if (!ids) {
+        throw std::invalid_argument("graph snapshots need integer node names");
+    }
+
+    SnapshotHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, SnapshotMagic, sizeof(SnapshotMagic));
+    header.version = SnapshotVersion;
+    header.byteOrder = ByteOrderMark;
+    header.nodeCount = nodeCount;
+    header.edgeCount = edgeCount;
+    for (int j = 0; j < 3 && nodeCount > 0; j++) {
+        header.min[j] = bounds.min[j];
+        header.max[j] = bounds.max[j];
+    }
+    if (!source.empty() && !sourceStamp(source, &header.sourceSize, &header.sourceModified)) {
+        throw std::runtime_error("cannot read map file: " + source);
+    }
+    header.offsets = align8(sizeof(header));
+    header.targets = align8(header.offsets + 4 * (static_cast<uint64_t>(nodeCount) + 1));
+    header.weights = align8(header.targets + 4 * static_cast<uint64_t>(edgeCount));
+    header.positions = align8(header.weights + 4 * static_cast<uint64_t>(edgeCount));
+    header.ids = align8(header.positions + 12 * static_cast<uint64_t>(nodeCount));
+    header.order = align8(header.ids + 8 * static_cast<uint64_t>(nodeCount));
+    header.size = header.order + 4 * static_cast<uint64_t>(nodeCount);
+
+    // Other processes may have the old snapshot mapped, and truncating it
+    // would fault their next read, so the new one is written beside it and
+    // renamed over it.  The name is per process as several may rebuild at once.
+    const std::string temporary = file + ".tmp" + std::to_string(getpid());
+    std::ofstream out(temporary.c_str(), std::ios::binary | std::ios::trunc);
+    auto section = [&out](uint64_t offset, const void* data, uint64_t bytes) {
+        static const char padding[8] = {0};
+        out.write(padding, offset - static_cast<uint64_t>(out.tellp()));
+        out.write(static_cast<const char*>(data), bytes);
+    };
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    section(header.offsets, offsets, 4 * (static_cast<uint64_t>(nodeCount) + 1));
+    section(header.targets, targets, 4 * static_cast<uint64_t>(edgeCount));
+    section(header.weights, weights, 4 * static_cast<uint64_t>(edgeCount));
+    section(header.positions, positions, 12 * static_cast<uint64_t>(nodeCount));
+    section(header.ids, ids, 8 * static_cast<uint64_t>(nodeCount));
+    section(header.order, order, 4 * static_cast<uint64_t>(nodeCount));
+    out.close();
+    if (!out || rename(temporary.c_str(), file.c_str()) != 0) {
+        unlink(temporary.c_str());
+        throw std::runtime_error("cannot write graph snapshot: " + file);
+    }
+}
+
+uint64_t CsrGraph::Fingerprint() const {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    hash = fnv1a(hash, &nodeCount, sizeof(nodeCount));
+    hash = fnv1a(hash, &edgeCount, sizeof(edgeCount));
+    hash = fnv1a(hash, offsets, 4 * (static_cast<size_t>(nodeCount) + 1));
+    hash = fnv1a(hash, targets, 4 * static_cast<size_t>(edgeCount));
+    hash = fnv1a(hash, weights, 4 * static_cast<size_t>(edgeCount));
+    hash = fnv1a(hash, positions, 12 * static_cast<size_t>(nodeCount));
+    if (ids) {
+        hash = fnv1a(hash, ids, 8 * static_cast<size_t>(nodeCount));
+    } else {
+        for (uint32_t i = 0; i < nodeCount; i++) {
+            const std::string& name = NameOf(i);
+            hash = fnv1a(hash, name.c_str(), name.size() + 1);
+        }
+    }
+    return hash;
+}
+
+void CsrGraph::BuildNames() const {
+    std::call_once(namesBuilt, [this]() {
+        if (names.empty() && ids) {
+            names.reserve(nodeCount);
+            for (uint32_t i = 0; i < nodeCount; i++) {
+                names.push_back(std::to_string(ids[i]));
+            }
+        }
+        lookup.reserve(nodeCount);
+        for (uint32_t i = 0; i < nodeCount; i++) {
+            lookup[names[i]] = i;
+        }
+    });
+}
+
+const std::string& CsrGraph::NameOf(uint32_t node) const {
+    BuildNames();
+    return names[node];
+}
+
+const CsrGraph::ReverseEdges& CsrGraph::GetReverseEdges() const {
+    std::call_once(reverseBuilt, [this]() {
+        reverse.offsets.assign(nodeCount + 1, 0);
+        for (uint32_t e = 0; e < edgeCount; e++) {
+            reverse.offsets[targets[e] + 1]++;
+        }
+        for (uint32_t i = 0; i < nodeCount; i++) {
+            reverse.offsets[i + 1] += reverse.offsets[i];
+        }
+
+        reverse.sources.resize(edgeCount);
+        reverse.weights.resize(edgeCount);
+        std::vector<uint32_t> next(reverse.offsets.begin(), reverse.offsets.end() - 1);
+        for (uint32_t u = 0; u < nodeCount; u++) {
+            for (uint32_t e = offsets[u]; e < offsets[u + 1]; e++) {
+                uint32_t slot = next[targets[e]]++;
+                reverse.sources[slot] = u;
+                reverse.weights[slot] = weights[e];
+            }
+        }
+    });
+    return reverse;
+}
+
+void CsrGraph::BuildNodeViews() const {
+    std::call_once(viewsBuilt, [this]() {
+        views.reserve(NodeCount());
+        for (uint32_t i = 0; i < NodeCount(); i++) {
+            views.push_back(new CsrGraphNode(this, i));
+        }
+        for (uint32_t i = 0; i < NodeCount(); i++) {
+            CsrGraphNode* node = static_cast<CsrGraphNode*>(views[i]);
+            node->neighbors.reserve(EdgeEnd(i) - EdgeBegin(i));
+            node->weighted.reserve(EdgeEnd(i) - EdgeBegin(i));
+            for (uint32_t e = EdgeBegin(i); e < EdgeEnd(i); e++) {
+                node->neighbors.push_back(views[EdgeTarget(e)]);
+                node->weighted.push_back({views[EdgeTarget(e)], EdgeWeight(e)});
+            }
+        }
+    });
+}
+
+const IGraphNode* CsrGraph::GetNode(const std::string& name) const {
+    uint32_t node = IndexOf(name);
+    if (node == InvalidNode) {
+        return NULL;
+    }
+    BuildNodeViews();
+    return views[node];
+}
+
+const std::vector<IGraphNode*>& CsrGraph::GetNodes() const {
+    BuildNodeViews();
+    return views;
+}
+
+uint32_t CsrGraph::IndexOf(const std::string& name) const {
+    BuildNames();
+    auto it = lookup.find(name);
+    return it == lookup.end() ? InvalidNode : it->second;
+}
+
+SpatialIndex* CsrGraph::BuildSpatialIndex() const {
+    return new SpatialIndex(positions, NodeCount());
+}
+
+uint32_t CsrGraph::NearestIndex(const float point[3]) const {
+    uint32_t node = GetSpatialIndex().Nearest(point);
+    return node == SpatialIndex::NotFound ? InvalidNode : node;
+}
+
+const IGraphNode* CsrGraph::NearestNode(std::vector<float> point, const DistanceFunction& distance) const {
+    if (typeid(distance) != typeid(EuclideanDistance)) {
+        return GraphBase::NearestNode(point, distance);
+    }
+
+    point.resize(3, 0.0f);
+    uint32_t node = NearestIndex(point.data());
+    if (node == InvalidNode) {
+        return NULL;
+    }
+    BuildNodeViews();
+    return views[node];
+}
+
+}
@@ -1,3 +1,5 @@
+#include <cerrno>
+#include <cstdlib>
 #include <stdexcept>
 #include <limits>
 #include "parsers/osm/osm_graph.h"
@@ -12,7 +14,7 @@ using std::numeric_limits;
 
 namespace routing {
 
-OSMNode::OSMNode(Point3 loc, string name) : loc_(loc), name_(name) { };
+OSMNode::OSMNode(Point3 loc, int64_t id) : id_(id), name_(std::to_string(id)), loc_(loc) { };
 
 /*const vector< vector<float> > OSMGraph::GetPath(vector<float> src, vector<float> dest) const {
   const IGraphNode* start_node = entity_project::NearestNode(this, src);
@@ -34,12 +36,11 @@ OSMGraph::~OSMGraph() {
 };
 
 void OSMGraph::AddNode(OSMNode* node) {
-    const string name = node->GetName();
-    if(lookup_.find(name) != lookup_.end()) {
+    if(lookup_.find(node->GetId()) != lookup_.end()) {
         // attempting to add duplicate Node
-        throw invalid_argument(name);
+        throw invalid_argument(node->GetName());
     }
-    lookup_.insert({name, node});
+    lookup_.insert({node->GetId(), node});
     nodes_.push_back(node);
 };
 
@@ -49,20 +50,41 @@ void OSMGraph::AddEdge(const string name1, const string name2) {
     node1->AddNeighbour(node2);
 };
 
+bool OSMGraph::parse_id(const string& name, int64_t& id) {
+    char* end;
+    errno = 0;
+    long long value = std::strtoll(name.c_str(), &end, 10);
+    if (end == name.c_str() || *end != '\0' || errno == ERANGE) {
+        return false;
+    }
+    id = value;
+    return true;
+}
+
 OSMNode* OSMGraph::node_named(const string name) const {
-    auto result = lookup_.find(name);
+    int64_t id;
+    if (!parse_id(name, id)) {
+        throw invalid_argument(name);
+    }
+    auto result = lookup_.find(id);
     if (result == lookup_.end()) {
         throw invalid_argument(name);
     }
     return result->second;
 };
 
+const OSMNode* OSMGraph::NodeWithId(int64_t id) const {
+    auto result = lookup_.find(id);
+    return result == lookup_.end() ? NULL : result->second;
+};
+
 const OSMNode* OSMGraph::NodeNamed(const string name) const {
     return node_named(name);
 };
 
 bool OSMGraph::Contains(const string name) const {
-    return !(lookup_.find(name) == lookup_.end());
+    int64_t id;
+    return parse_id(name, id) && lookup_.find(id) != lookup_.end();
 };
 
 };
\ No newline at end of file
@@ -10,6 +10,9 @@ IGraph* OSMGraphFactory::Create(const std::string& file) const {
 		return NULL;
 	}
 
+	if (threads > 1) {
+		return OsmParser::LoadGraphFromFile(file, false, threads);
+	}
 	return OsmParser::LoadGraphFromFile(file, false);
 }
 
@@ -1,267 +1,369 @@
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
-#include <set>
+#include <memory>
+#include <stdexcept>
 #include <string>
-#include <unordered_map>
-#include <unordered_set>
 
 #include "parsers/osm/osm_parser.h"
-#include "util/xml/pugixml.h"
-#include <limits.h>
+#include "parsers/osm/osm_stream.h"
+#include "util/parallel_for.h"
 
-using std::logic_error;
-using std::invalid_argument;
+using std::runtime_error;
 
-using std::set;
 using std::string;
 
 namespace routing {
 
-template <class T, class V>
-unordered_map<V, int>* count_value_occurrences(const unordered_map<T, V>* to_count) {
-    unordered_map<V, int>* result = new unordered_map<V, int>();
-
-    for (auto kv : *to_count) {
-        auto existing_info = result->find(kv.second);
-        if (existing_info == result->end()) {
-            result->insert({kv.second, 1});
-        } else {
-            existing_info->second += 1;
-        }
-    }
-
-    return result;
-};
-
+// OSM ids are signed 64-bit integers; negative ones are objects not yet
+// uploaded.
+// Warns about the highway nodes missing from the file; their segments are
+// left out.
 template <class T>
-T argmax(const unordered_map<T, int>* mapping) {
-    // this iterates through the list twice
-    // because T max_found; isn't always valid
-    // if T doesn't define a default constructor
-    int max = INT_MIN;
-
-    for (auto kv: *mapping) {
-        if(kv.second > max) {
-            max = kv.second;
+static void report_missing(const vector<int64_t>& ids, const vector<T*>& nodes) {
+    for (size_t i = 0; i < ids.size(); i++) {
+        if (!nodes[i]) {
+            std::cerr << "Node ID: " << ids[i] << " not found. Continuing." << std::endl;
         }
     }
+}
 
-    for (auto kv: *mapping) {
-        if(kv.second == max) {
-            return kv.first;
-        }
-    }
-
-    throw invalid_argument("no max in mapping");
-};
-
-template <class T, class V>
-unordered_map<T, bool>* where_equal(const unordered_map<T, int>* mapping, V equal_to){
-    unordered_map<T, bool>* result = new unordered_map<T, bool>();
-
-    for (auto kv: *mapping) {
-        result->insert({
-            kv.first,
-            kv.second == equal_to});
+static bool parse_id(const char* text, int64_t& id) {
+    char* end;
+    errno = 0;
+    long long value = std::strtoll(text, &end, 10);
+    if (end == text || *end != '\0' || errno == ERANGE) {
+        return false;
     }
-
-    return result;
+    id = value;
+    return true;
 }
 
-class GraphUtils {
-    public :  
-        static unordered_map<string, int>* ConnectedComponents(const IGraph* graph);
-        static OSMGraph* Filter(const IGraph* original, const unordered_map<string, bool>* filter);
-        static OSMGraph* FilterToLargestConnectedComponent(const IGraph* graph);
-    private:
-        static void dfs_visit(const IGraphNode* n, unordered_map<string, int>* record, int index);
-};
-
-unordered_map<string, int>* GraphUtils::ConnectedComponents(const IGraph* graph) {
-    unordered_map<string, int>* visited = new unordered_map<string, int>();
-    int index = 0;
-
-    for (auto* node : graph->GetNodes()) {
-        if(visited->find(node->GetName()) == visited->end()) {
-            // we haven't seen this node before
-            GraphUtils::dfs_visit(node, visited, index);
-            index += 1;
-        }
+// Union-find over the integers below 'count' that several threads may unite
+// at once without locks.  Every root is the lowest member of its set, so the
+// sets do not depend on the order of the unions.
+class DisjointSets {
+public:
+  explicit DisjointSets(size_t count) : parent(count) {
+    for (size_t i = 0; i < count; i++) {
+      parent[i].store(static_cast<uint32_t>(i), std::memory_order_relaxed);
     }
+  }
 
-    return visited;
-}
-
-OSMGraph* GraphUtils::Filter(const IGraph* original, const unordered_map<string, bool>* filter) {
-    // NOTE: does not preserve the type of the graph that was input, always gives back an OSMGraph
-    OSMGraph* filtered_graph = new OSMGraph();
-
-    // copy over all of the nodes for which filter(node->GetName()) is true
-    for (auto kv : *filter) {
-        const bool include = kv.second;
-        if (include) {
-            const string name = kv.first;
-            const IGraphNode* existing_node = original->GetNode(name);
-            if(existing_node) {
-                vector<float> loc = existing_node->GetPosition();
-                filtered_graph->AddNode(
-                    new OSMNode(
-                        Point3(loc.at(0), loc.at(1), loc.at(2)),
-                        existing_node->GetName()));
-            } else {
-                throw logic_error(name);
-            }
-        }
+  uint32_t Find(uint32_t node) {
+    while (true) {
+      uint32_t up = parent[node].load(std::memory_order_relaxed);
+      if (up == node) {
+        return node;
+      }
+      uint32_t upper = parent[up].load(std::memory_order_relaxed);
+      if (upper != up) {
+        // path halving; losing the race only means less halving
+        parent[node].compare_exchange_weak(up, upper, std::memory_order_relaxed);
+      }
+      node = upper;
     }
+  }
 
-    for (IGraphNode* node : original->GetNodes()) {
-        auto from_filter = filter->find(node->GetName());
-        if (from_filter == filter->end()) {
-            throw invalid_argument(node->GetName());
-        } // implicit else
-        if (from_filter->second) {
-            // from node is in the filter            
-            for (IGraphNode* other : node->GetNeighbors()) {
-                auto to_filter = filter->find(other->GetName());
-                if (to_filter == filter->end()) {
-                    throw invalid_argument(node->GetName());
-                } // implicit else
-                if (to_filter->second) {
-                    // both nodes in the filter
-                    filtered_graph->AddEdge(node->GetName(), other->GetName());
-                }
-            }
-        }
+  void Unite(uint32_t a, uint32_t b) {
+    while (true) {
+      a = Find(a);
+      b = Find(b);
+      if (a == b) {
+        return;
+      }
+      if (a < b) {
+        std::swap(a, b);
+      }
+      // fails if another thread has just linked 'a', then retries from its new root
+      uint32_t root = a;
+      if (parent[a].compare_exchange_strong(root, b)) {
+        return;
+      }
     }
+  }
 
-    return filtered_graph;
+private:
+  vector<std::atomic<uint32_t>> parent;
 };
 
-OSMGraph* GraphUtils::FilterToLargestConnectedComponent(const IGraph* original) {
-    unordered_map<string, int>* cc_mapping = GraphUtils::ConnectedComponents(original);
-    unordered_map<int, int>* cc_sizes = count_value_occurrences(cc_mapping);
-    int largest_subgraph_idx = argmax(cc_sizes);
-    unordered_map<string, bool>* in_largest_cc = where_equal(cc_mapping, largest_subgraph_idx);
-    OSMGraph* result = GraphUtils::Filter(original, in_largest_cc);
-
-    delete cc_mapping;
-    delete cc_sizes;
-    delete in_largest_cc;
-    
-    return result;
-}
-
-void GraphUtils::dfs_visit(const IGraphNode* n, unordered_map<string, int>* record, int index) {
-    if (record->find(n->GetName()) == record->end()) {
-        record->insert({n->GetName(), index});
-
-        for (auto* neighbour : (n->GetNeighbors())) {
-            GraphUtils::dfs_visit(neighbour, record, index);
-        }
-    }
-}
-
 OSMGraph* OsmParser::LoadGraphFromFile(string filename, bool debug) {
-  pugi::xml_document doc;
-  pugi::xml_parse_result result = doc.load_file(filename.c_str());
-  // sanity check, make sure the document loaded, and print something (anything) from the document
   #ifdef DEBUG
     std::cerr << "Loading graph using updated code" << std::endl;
   #endif
+  return LoadGraphFromFile(filename, debug, 1);
+}
 
-  OSMGraph* geazy = read_nodes(&doc, debug);
-
-  read_adjacencies_to(geazy, &doc, debug);
-  OSMGraph* connected = GraphUtils::FilterToLargestConnectedComponent(geazy);
-  delete geazy;
-  return connected;
-};
-
-OSMGraph* OsmParser::without_lonely_nodes(OSMGraph* geazy) {
-  // this literally creates a new graph that's a copy except for 
-  // the nodes with degree 0
-  // believe it or not, this is actually faster & safer than deleting
-  // all of the nodes from the existing graph*
-  OSMGraph* newGraph = new OSMGraph();
-
-  for (IGraphNode* node : geazy->GetNodes()) {
-    if(node->GetNeighbors().size() > 0) {
-      OSMNode* newNode = new OSMNode(node->GetPosition(), node->GetName());
-      newGraph->AddNode(newNode);
+OSMGraph* OsmParser::LoadGraphFromFile(string filename, bool debug, unsigned threads, Timings* timings) {
+  typedef std::pair<int64_t, int64_t> Segment;
+  Timings spent = Timings();
+  auto started = std::chrono::steady_clock::now();
+  auto lap = [&started](double& phase) {
+    auto now = std::chrono::steady_clock::now();
+    phase = std::chrono::duration<double>(now - started).count();
+    started = now;
+  };
+
+  // several chunks per thread, since the ways and the nodes each fill only
+  // part of the file and every pass skips the rest
+  threads = std::max(1u, threads);
+  const uint64_t size = OsmStream::FileSize(filename);
+  const size_t chunks = threads == 1 ? 1 : static_cast<size_t>(std::max<uint64_t>(1, std::min<uint64_t>(4 * threads, size >> 20)));
+  auto chunk_begin = [&](size_t chunk) { return size * chunk / chunks; };
+
+  vector<vector<Segment>> segments(chunks);
+  vector<Bounds> chunk_bounds(chunks);
+  vector<char> has_bounds(chunks, 0);
+  ParallelFor(chunks, threads, [&](size_t chunk) {
+    vector<Segment>& edges = segments[chunk];
+    has_bounds[chunk] = read_highways(filename, chunk_begin(chunk), chunk_begin(chunk + 1), edges, chunk_bounds[chunk]);
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+  });
+  auto with_bounds = std::find(has_bounds.begin(), has_bounds.end(), 1);
+  if (with_bounds == has_bounds.end()) {
+    throw runtime_error(filename + " has no bounds");
+  }
+  const Bounds bounds = chunk_bounds[with_bounds - has_bounds.begin()];
+  lap(spent.ways);
+
+  // pairwise merges of the sorted chunk buffers, each round in parallel
+  while (segments.size() > 1) {
+    vector<vector<Segment>> merged((segments.size() + 1) / 2);
+    ParallelFor(merged.size(), threads, [&](size_t i) {
+      if (2 * i + 1 == segments.size()) {
+        merged[i].swap(segments[2 * i]);
+        return;
+      }
+      vector<Segment>& first = segments[2 * i];
+      vector<Segment>& second = segments[2 * i + 1];
+      merged[i].resize(first.size() + second.size());
+      std::merge(first.begin(), first.end(), second.begin(), second.end(), merged[i].begin());
+      vector<Segment>().swap(first);
+      vector<Segment>().swap(second);
+    });
+    segments.swap(merged);
+  }
+  vector<Segment> edges;
+  edges.swap(segments[0]);
+  edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+  vector<int64_t> ids;
+  for (const Segment& edge : edges) {
+    if (ids.empty() || ids.back() != edge.first) {
+      ids.push_back(edge.first);
+    }
+  }
+  // the same segments by position in ids, still sorted by the first node
+  const size_t blocks = threads == 1 ? 1 : 4 * threads;
+  vector<std::pair<uint32_t, uint32_t>> arcs(edges.size());
+  ParallelFor(blocks, threads, [&](size_t block) {
+    size_t e = edges.size() * block / blocks;
+    uint32_t from = std::lower_bound(ids.begin(), ids.end(), e < edges.size() ? edges[e].first : 0) - ids.begin();
+    for (; e < edges.size() * (block + 1) / blocks; e++) {
+      while (ids[from] != edges[e].first) {
+        from++;
+      }
+      arcs[e].first = from;
+      arcs[e].second = std::lower_bound(ids.begin(), ids.end(), edges[e].second) - ids.begin();
+    }
+  });
+  vector<Segment>().swap(edges);
+  lap(spent.adjacency);
+
+  vector<vector<Located>> located(chunks);
+  ParallelFor(chunks, threads, [&](size_t chunk) {
+    read_nodes(filename, chunk_begin(chunk), chunk_begin(chunk + 1), bounds, ids, located[chunk]);
+  });
+  lap(spent.nodes);
+
+  // the first of duplicate nodes wins, as in the order of the file
+  vector<const Located*> chosen(ids.size(), NULL);
+  for (const vector<Located>& chunk : located) {
+    for (const Located& node : chunk) {
+      if (chosen[node.index]) {
+        std::cerr << "Attempted to add duplicate node. ID: " << ids[node.index];
+        std::cerr << ". Continuing" << std::endl;
+      } else {
+        chosen[node.index] = &node;
+      }
     }
   }
 
-  for (IGraphNode* node : geazy->GetNodes()) {
-    const string name = node->GetName();
-    for(IGraphNode* other : node->GetNeighbors()) {
-      const string other_name = other->GetName();
-      newGraph->AddEdge(name, other_name);
+  // only the largest component is turned into nodes, so nothing is copied
+  // or removed afterwards
+  DisjointSets sets(ids.size());
+  ParallelFor(blocks, threads, [&](size_t block) {
+    for (size_t e = arcs.size() * block / blocks; e < arcs.size() * (block + 1) / blocks; e++) {
+      if (arcs[e].first < arcs[e].second && chosen[arcs[e].first] && chosen[arcs[e].second]) {
+        sets.Unite(arcs[e].first, arcs[e].second);
+      }
+    }
+  });
+  vector<uint32_t> component(ids.size());
+  ParallelFor(blocks, threads, [&](size_t block) {
+    for (size_t i = ids.size() * block / blocks; i < ids.size() * (block + 1) / blocks; i++) {
+      component[i] = sets.Find(i);
+    }
+  });
+  vector<uint32_t> sizes(ids.size(), 0);
+  uint32_t largest = 0;
+  for (uint32_t i = 0; i < ids.size(); i++) {
+    if (chosen[i] && ++sizes[component[i]] > sizes[largest]) {
+      largest = component[i];
+    }
+  }
+  lap(spent.components);
+
+  std::unique_ptr<OSMGraph> graph(new OSMGraph());
+  vector<OSMNode*> nodes(ids.size(), NULL);
+  for (const vector<Located>& chunk : located) {
+    for (const Located& node : chunk) {
+      if (chosen[node.index] == &node && component[node.index] == largest) {
+        nodes[node.index] = new OSMNode(node.loc, ids[node.index]);
+        graph->AddNode(nodes[node.index]);
+      }
     }
   }
+  vector<vector<Located>>().swap(located);
+  report_missing(ids, chosen);
+
+  // blocks start at a new first node, so no two threads add to one node
+  ParallelFor(blocks, threads, [&](size_t block) {
+    size_t e = arcs.size() * block / blocks;
+    while (e > 0 && e < arcs.size() && arcs[e].first == arcs[e - 1].first) {
+      e++;
+    }
+    const size_t block_end = arcs.size() * (block + 1) / blocks;
+    for (; e < arcs.size() && (e < block_end || (e > 0 && arcs[e].first == arcs[e - 1].first)); e++) {
+      if (nodes[arcs[e].first] && nodes[arcs[e].second]) {
+        nodes[arcs[e].first]->AddNeighbour(nodes[arcs[e].second]);
+      }
+    }
+  });
+  lap(spent.graph);
 
-  return newGraph;
+  if (debug) {
+    std::cerr << "Imported " << filename << " on " << threads << " threads in " << chunks << " chunks:"
+              << " ways " << spent.ways << "s, adjacency " << spent.adjacency << "s, nodes " << spent.nodes
+              << "s, components " << spent.components << "s, graph " << spent.graph << "s" << std::endl;
+  }
+  if (timings) {
+    *timings = spent;
+  }
+  return graph.release();
 }
 
-OSMGraph* OsmParser::read_nodes(pugi::xml_document* doc, bool debug) {
-    pugi::xml_node parent_of_nodes = doc->first_child();
-    pugi::xml_node way_node;
+bool OsmParser::read_highways(const string& filename, uint64_t begin, uint64_t end,
+                              vector<std::pair<int64_t, int64_t>>& edges, Bounds& bounds) {
+  OsmStream stream(filename, begin);
+  OsmStream::Tag tag;
+
+  bool has_bounds = false;
+  // the way being read, if any, and the nodes it lists so far; a way that
+  // started before 'begin' belongs to the previous range and is skipped
+  bool in_way = false;
+  bool highway = false;
+  vector<int64_t> refs;
+
+  while (stream.Next(tag)) {
+    if (!in_way && stream.Offset() >= end) {
+      break;
+    }
+
+    if (tag.name == "bounds" && tag.type != OsmStream::Close) {
+      const char* minlat = tag.Attribute("minlat");
+      const char* minlon = tag.Attribute("minlon");
+      const char* maxlat = tag.Attribute("maxlat");
+      const char* maxlon = tag.Attribute("maxlon");
+      if (!minlat || !minlon || !maxlat || !maxlon) {
+        throw runtime_error("Improperly formed bounds in " + filename);
+      }
+      bounds.minlat = std::strtod(minlat, NULL);
+      bounds.minlon = std::strtod(minlon, NULL);
+      bounds.maxlat = std::strtod(maxlat, NULL);
+      bounds.maxlon = std::strtod(maxlon, NULL);
+      has_bounds = true;
+    } else if (tag.name == "way") {
+      if (tag.type == OsmStream::Open) {
+        in_way = true;
+        highway = false;
+        refs.clear();
+      } else if (tag.type == OsmStream::Close && in_way) {
+        in_way = false;
+        for (size_t i = 1; highway && i < refs.size(); i++) {
+          edges.push_back({refs[i - 1], refs[i]});
+          edges.push_back({refs[i], refs[i - 1]});
+        }
+      }
+    } else if (in_way && tag.name == "nd") {
+      int64_t ref;
+      const char* text = tag.Attribute("ref");
+      if (text && parse_id(text, ref)) {
+        refs.push_back(ref);
+      } else {
+        std::cerr << "Improperly formed nd missing ref. Continuing." << std::endl;
+      }
+    } else if (in_way && tag.name == "tag") {
+      const char* key = tag.Attribute("k");
+      if (key && strcmp(key, "highway") == 0) {
+        highway = true;
+      }
+    }
+  }
 
-    OSMGraph* graph = new OSMGraph();
+  return has_bounds;
+}
 
-    pugi::xml_node bounds = parent_of_nodes.child("bounds");
-    float minlat = std::stod(bounds.attribute("minlat").value());
-    float minlon = std::stod(bounds.attribute("minlon").value());
-    float maxlat = std::stod(bounds.attribute("maxlat").value());
-    float maxlon = std::stod(bounds.attribute("maxlon").value());
-    float centerLat = minlat + (maxlat-minlat)/2.0;
-    float centerLon = minlon + (maxlon-minlon)/2.0;
-    //std::cout << minlat << " " << minlon << " " << maxlat << " " << maxlon << std::endl;)
+void OsmParser::read_nodes(const string& filename, uint64_t begin, uint64_t end, const Bounds& bounds,
+                           const vector<int64_t>& ids, vector<Located>& located) {
+    OsmStream stream(filename, begin);
+    OsmStream::Tag tag;
 
-    std::string id;
-    std::string lat;
-    std::string lon;
+    float centerLat = bounds.minlat + (bounds.maxlat-bounds.minlat)/2.0;
+    float centerLon = bounds.minlon + (bounds.maxlon-bounds.minlon)/2.0;
 
-    for(way_node = parent_of_nodes.child("node"); way_node != nullptr; way_node = way_node.next_sibling("node")) {
+    while (stream.Next(tag) && stream.Offset() < end) {
+      if (tag.name != "node" || tag.type == OsmStream::Close) {
+        continue;
+      }
 
-      if(!way_node.attribute("id")) {
+      const char* id = tag.Attribute("id");
+      const char* lat = tag.Attribute("lat");
+      const char* lon = tag.Attribute("lon");
+      int64_t value;
+      if (!id || !parse_id(id, value)) {
         std::cerr << "Improperly formed node missing id. Continuing." << std::endl;
         continue;
       }
-      if(!way_node.attribute("lat")) {
-        std::cerr << "Improperly formed node missing lat. ID: " << way_node.attribute("ref");
-        std::cerr << ". Continuing" << std::endl;
+      auto found = std::lower_bound(ids.begin(), ids.end(), value);
+      if (found == ids.end() || *found != value) {
+        // not on any highway
         continue;
       }
-      if(!way_node.attribute("lon")) {
-        std::cerr << "Improperly formed node missing lon. ID: " << way_node.attribute("ref");
+      if (!lat) {
+        std::cerr << "Improperly formed node missing lat. ID: " << id;
         std::cerr << ". Continuing" << std::endl;
         continue;
       }
-      id = way_node.attribute("id").value();
-      lat = way_node.attribute("lat").value();
-      lon = way_node.attribute("lon").value();
-
-      if (graph->Contains(id)) {
-        std::cerr << "Attempted to add duplicate node. ID: " << way_node.attribute("ref");
+      if (!lon) {
+        std::cerr << "Improperly formed node missing lon. ID: " << id;
         std::cerr << ". Continuing" << std::endl;
+        continue;
       }
 
-      float latitude = std::stod(lat);
-      float longitude = std::stod(lon);
-      float latN = OsmParser::normalize(latitude, minlat, maxlat);
-      float lonN = OsmParser::normalize(longitude, minlon, maxlon);
+      float latitude = std::strtod(lat, NULL);
+      float longitude = std::strtod(lon, NULL);
 
       longitude = OsmParser::getLon(latitude,longitude, centerLat, centerLon);
       latitude = -(latitude-centerLat)* 40008000.0 / 360.0;
       float height = 264.0f;
 
-      graph->AddNode(
-        new OSMNode(
-          Point3(longitude, height, latitude),
-          id));
-          
+      located.push_back({static_cast<uint32_t>(found - ids.begin()), Point3(longitude, height, latitude)});
     }
-
-    return graph;
 };
 
 float OsmParser::normalize(float val, float max, float min) {
@@ -280,91 +382,4 @@ float OsmParser::asRadians(float degrees) {
   return degrees * 3.14159f / 180.0f;
 }
 
-void OsmParser::read_adjacencies_to(OSMGraph* graph, pugi::xml_document* doc, bool debug) {
-  unordered_map<string, set<string>> adjacencies = get_adjacency_list_from_file(doc, debug);
-
-  for(auto it : adjacencies) {
-    string from = it.first;
-    set<string> others = it.second;
-    if(!graph->Contains(from)) {
-      std::cerr << "Node ID: " << from << " not found. Continuing." << std::endl;
-      continue;
-    } // implicit else
-
-    for(string to : others) {
-      if(!graph->Contains(to)) {
-        std::cerr << "Node ID: " << to << " not found. Continuing." << std::endl;
-        continue;
-      } // implicit else
-
-      graph->AddEdge(from, to);
-    }
-  }
-};
-
-std::unordered_map<std::string, std::set<std::string>>
-    OsmParser::get_adjacency_list_from_file(pugi::xml_document* doc, bool debug) {
-
-  // create a parent of all (interesting) nodes, then get the first node the the "way" name
-  pugi::xml_node parent_of_nodes = doc->first_child();
-  pugi::xml_node way_node = parent_of_nodes.child("way");
-  // create a hashmap the takes a string id and returns the xml_node
-  //  corresponding to the "way" node with the same id
-  std::unordered_map<std::string, pugi::xml_node> highway_way_nodes =
-    std::unordered_map<std::string, pugi::xml_node>();
-  // while the current way node is not equal to null, if it has a highway tag, add it to the hashmap
-  //  of ids to way nodes
-  while (way_node != NULL) {  
-    for(pugi::xml_node tag_node = way_node.child("tag"); tag_node != nullptr; tag_node = tag_node.next_sibling("tag")) {
-      if (tag_node != NULL &&
-          strcmp(tag_node.attribute("k").value(), "highway") == 0) {
-        highway_way_nodes.insert({way_node.attribute("id").value(), way_node});
-        break;
-      }
-    }
-    way_node = way_node.next_sibling();
-  }
-  // get all the string ids of nodes that are a part of highway ways, we don't care about the order
-  //  and don't want repeats, so we use a unordered set
-  std::unordered_set<std::string> highway_node_ids = std::unordered_set<std::string>();
-  // for every highway way node, any child named "nd" is a node that is part of the way,
-  //  so add it to the highway node ids set
-  for (auto & pair : highway_way_nodes) {
-    pugi::xml_node way_node_child = pair.second.child("nd");
-    while (way_node_child != NULL) {
-      // if the node's name is not nd, we don't care about it, so skip. otherwise add to set
-      if (strcmp(way_node_child.name(), "nd") == 0) {
-        highway_node_ids.insert(way_node_child.attribute("ref").value());
-      }
-      way_node_child = way_node_child.next_sibling();
-    }
-  }
-  // we want an adjacency list that maps from a node's id to a list of nodes it is connected to
-  std::unordered_map<std::string, std::set<std::string>> adjacency_list =
-  std::unordered_map<std::string, std::set<std::string>>();
-  // initialize it
-  for (auto highway_node_id : highway_node_ids) {
-    adjacency_list.insert({highway_node_id, std::set<std::string>()});
-  }
-  int num_edges = 0;
-  // for every way node, adjacent "nd" nodes are connected, iterate through and connect
-  //  adjacent nodes in the adjacency list
-  for (auto way_node_key_value : highway_way_nodes) {
-    pugi::xml_node first = way_node_key_value.second.child("nd");
-    pugi::xml_node second = way_node_key_value.second.child("nd").next_sibling();
-    while (second != NULL) {
-      // if either first or second nodes aren't "nd" nodes, skip
-      //  otherwise assign each to the other's adjacency list
-      if (strcmp(first.name(), "nd") == 0 && strcmp(second.name(), "nd") == 0) {
-        adjacency_list[first.attribute("ref").value()].insert(second.attribute("ref").value());
-        adjacency_list[second.attribute("ref").value()].insert(first.attribute("ref").value());
-        num_edges++;
-      }
-      first = second;
-      second = second.next_sibling();
-    }
-  }
-  return adjacency_list;
-};
-
 }
\ No newline at end of file
@@ -0,0 +1,196 @@
+#include "parsers/osm/osm_stream.h"
+
+#include <sys/types.h>
+
+#include <cstring>
+#include <stdexcept>
+
+using std::runtime_error;
+using std::string;
+
+namespace routing {
+
+namespace {
+
+bool is_space(int c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+bool ends_name(int c) {
+  return is_space(c) || c == '=' || c == '/' || c == '>' || c == EOF;
+}
+
+}
+
+const char* OsmStream::Tag::Attribute(const char* attribute) const {
+  for (size_t i = 0; i < count; i++) {
+    if (attributes[i].first == attribute) {
+      return attributes[i].second.c_str();
+    }
+  }
+  return NULL;
+}
+
+OsmStream::OsmStream(const string& filename, uint64_t begin)
+    : filename(filename), buffer(1 << 16), base(begin), pos(0), end(0), offset(begin) {
+  file = std::fopen(filename.c_str(), "rb");
+  if (!file) {
+    throw runtime_error("Cannot open " + filename);
+  }
+  if (begin > 0 && fseeko(file, static_cast<off_t>(begin), SEEK_SET) != 0) {
+    std::fclose(file);
+    throw runtime_error("Cannot seek in " + filename);
+  }
+}
+
+OsmStream::~OsmStream() {
+  std::fclose(file);
+}
+
+uint64_t OsmStream::FileSize(const string& filename) {
+  FILE* file = std::fopen(filename.c_str(), "rb");
+  if (!file) {
+    throw runtime_error("Cannot open " + filename);
+  }
+  fseeko(file, 0, SEEK_END);
+  const off_t size = ftello(file);
+  std::fclose(file);
+  return size < 0 ? 0 : static_cast<uint64_t>(size);
+}
+
+bool OsmStream::fill() {
+  base += end;
+  pos = 0;
+  end = std::fread(buffer.data(), 1, buffer.size(), file);
+  return end > 0;
+}
+
+int OsmStream::get_in_tag() {
+  int c = get();
+  if (c == EOF) {
+    throw runtime_error(filename + " ends inside a tag");
+  }
+  return c;
+}
+
+void OsmStream::skip_past(const char* terminator) {
+  const size_t length = std::strlen(terminator);
+  string last;
+  while (last.size() < length || last.compare(last.size() - length, length, terminator) != 0) {
+    last.push_back(static_cast<char>(get_in_tag()));
+    if (last.size() > 2 * length) {
+      last.erase(0, last.size() - length);
+    }
+  }
+}
+
+void OsmStream::read_name(int first, string& name) {
+  name.clear();
+  for (int c = first; !ends_name(c); c = get_in_tag()) {
+    name.push_back(static_cast<char>(c));
+    if (ends_name(peek())) {
+      break;
+    }
+  }
+}
+
+void OsmStream::read_value(int quote, string& value) {
+  value.clear();
+  for (int c = get_in_tag(); c != quote; c = get_in_tag()) {
+    if (c != '&') {
+      value.push_back(static_cast<char>(c));
+      continue;
+    }
+
+    string entity;
+    for (c = get_in_tag(); c != ';' && c != quote && entity.size() < 8; c = get_in_tag()) {
+      entity.push_back(static_cast<char>(c));
+    }
+    if (entity == "amp") {
+      value.push_back('&');
+    } else if (entity == "lt") {
+      value.push_back('<');
+    } else if (entity == "gt") {
+      value.push_back('>');
+    } else if (entity == "quot") {
+      value.push_back('"');
+    } else if (entity == "apos") {
+      value.push_back('\'');
+    } else {
+      // numeric and unknown entities are kept as they are
+      value += "&" + entity + (c == ';' ? ";" : "");
+    }
+    if (c == quote) {
+      break;
+    }
+  }
+}
+
+bool OsmStream::Next(Tag& tag) {
+  while (true) {
+    int c = get();
+    while (c != '<' && c != EOF) {
+      c = get();
+    }
+    if (c == EOF) {
+      return false;
+    }
+    offset = base + pos - 1;
+
+    c = get_in_tag();
+    if (c == '?') {
+      skip_past("?>");
+      continue;
+    }
+    if (c == '!') {
+      if (peek() == '-') {
+        skip_past("-->");
+      } else if (peek() == '[') {
+        skip_past("]]>");
+      } else {
+        skip_past(">");
+      }
+      continue;
+    }
+
+    tag.count = 0;
+    if (c == '/') {
+      tag.type = Close;
+      read_name(get_in_tag(), tag.name);
+      skip_past(">");
+      return true;
+    }
+
+    read_name(c, tag.name);
+    while (true) {
+      c = get_in_tag();
+      if (is_space(c)) {
+        continue;
+      }
+      if (c == '>') {
+        tag.type = Open;
+        return true;
+      }
+      if (c == '/') {
+        skip_past(">");
+        tag.type = Empty;
+        return true;
+      }
+
+      if (tag.count == tag.attributes.size()) {
+        tag.attributes.resize(tag.count + 1);
+      }
+      std::pair<string, string>& attribute = tag.attributes[tag.count++];
+      read_name(c, attribute.first);
+      do {
+        c = get_in_tag();
+      } while (is_space(c) || c == '=');
+      if (c != '"' && c != '\'') {
+        throw runtime_error(filename + ": unquoted value of attribute " + attribute.first);
+      }
+      read_value(c, attribute.second);
+    }
+  }
+}
+
+};  // namespace routing
@@ -0,0 +1,133 @@
+#include "routing/alt.h"
+#include "routing/search_workspace.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace routing {
+
+Landmarks::Landmarks(const CsrGraph& graph, uint32_t count) : graph(graph) {
+    const uint32_t n = graph.NodeCount();
+    count = std::min(count, n);
+    fromLandmark.resize(size_t(n) * count);
+    toLandmark.resize(size_t(n) * count);
+
+    // the first landmark is the node farthest from node 0, every later one the
+    // node farthest from its nearest landmark; nodes the first landmark cannot
+    // reach are marked -1 and never picked
+    std::vector<float> nearest(n, -1.0f);
+    std::vector<float> from;
+    std::vector<float> to;
+    if (n > 0) {
+        Distances(0, true, from);
+        for (uint32_t v = 0; v < n; v++) {
+            nearest[v] = std::isinf(from[v]) ? -1.0f : from[v];
+        }
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t landmark = std::max_element(nearest.begin(), nearest.end()) - nearest.begin();
+        if (nearest[landmark] <= 0 && !nodes.empty()) {
+            break;
+        }
+        nodes.push_back(landmark);
+        Distances(landmark, true, from);
+        Distances(landmark, false, to);
+        for (uint32_t v = 0; v < n; v++) {
+            fromLandmark[size_t(v) * count + i] = from[v];
+            toLandmark[size_t(v) * count + i] = to[v];
+            if (std::isinf(from[v])) {
+                if (i == 0) {
+                    nearest[v] = -1.0f;
+                }
+            }
+            else {
+                nearest[v] = i == 0 ? from[v] : std::min(nearest[v], from[v]);
+            }
+        }
+    }
+
+    // fewer landmarks than asked for if the rest of the graph is unreachable
+    if (nodes.size() < count) {
+        std::vector<float> compactFrom(size_t(n) * nodes.size());
+        std::vector<float> compactTo(size_t(n) * nodes.size());
+        for (uint32_t v = 0; v < n; v++) {
+            for (uint32_t i = 0; i < nodes.size(); i++) {
+                compactFrom[size_t(v) * nodes.size() + i] = fromLandmark[size_t(v) * count + i];
+                compactTo[size_t(v) * nodes.size() + i] = toLandmark[size_t(v) * count + i];
+            }
+        }
+        fromLandmark.swap(compactFrom);
+        toLandmark.swap(compactTo);
+    }
+}
+
+// One-to-all Dijkstra from the landmark, along the edges if 'forward' and
+// against them otherwise.
+void Landmarks::Distances(uint32_t landmark, bool forward, std::vector<float>& result) const {
+    const CsrGraph::ReverseEdges& reverse = graph.GetReverseEdges();
+    SearchWorkspace::Lease search;
+    search->Reset(graph.NodeCount());
+    search->Reach(landmark, 0, SearchWorkspace::NoParent);
+    search->HeapPush(0, landmark);
+
+    while (!search->HeapEmpty()) {
+        const uint32_t node = search->HeapPop().second;
+        if (search->Closed(node)) {
+            continue;
+        }
+        search->Close(node);
+
+        const float distance = search->Distance(node);
+        const uint32_t begin = forward ? graph.EdgeBegin(node) : reverse.offsets[node];
+        const uint32_t end = forward ? graph.EdgeEnd(node) : reverse.offsets[node + 1];
+        for (uint32_t e = begin; e < end; e++) {
+            const uint32_t next = forward ? graph.EdgeTarget(e) : reverse.sources[e];
+            const float tentative = distance + (forward ? graph.EdgeWeight(e) : reverse.weights[e]);
+            if (tentative < search->Distance(next)) {
+                search->Reach(next, tentative, node);
+                search->HeapPush(tentative, next);
+            }
+        }
+    }
+
+    result.resize(graph.NodeCount());
+    for (uint32_t v = 0; v < graph.NodeCount(); v++) {
+        result[v] = search->Distance(v);
+    }
+}
+
+float Landmarks::LowerBound(uint32_t from, uint32_t to) const {
+    const size_t count = nodes.size();
+    const float* fromV = &fromLandmark[from * count];
+    const float* fromT = &fromLandmark[to * count];
+    const float* toV = &toLandmark[from * count];
+    const float* toT = &toLandmark[to * count];
+
+    float bound = 0.0f;
+    for (size_t i = 0; i < count; i++) {
+        // a landmark that cannot reach, or be reached from, either node says
+        // nothing about their distance
+        if (!std::isinf(fromV[i]) && !std::isinf(fromT[i])) {
+            bound = std::max(bound, fromT[i] - fromV[i]);
+        }
+        if (!std::isinf(toV[i]) && !std::isinf(toT[i])) {
+            bound = std::max(bound, toV[i] - toT[i]);
+        }
+    }
+    return bound;
+}
+
+ALT::ALT(const CsrGraph& graph, uint32_t landmarks)
+    : AStar(new EuclideanDistance(), new EuclideanDistance(), "alt"), landmarks(graph, landmarks) {
+}
+
+float ALT::LowerBound(const CsrGraph& g, uint32_t node, uint32_t goal) const {
+    if (&g != &landmarks.GetGraph()) {
+        return 0.0f;
+    }
+    return landmarks.LowerBound(node, goal);
+}
+
+}
@@ -0,0 +1,131 @@
+#include "routing/bidirectional_astar.h"
+#include "routing/astar.h"
+#include "routing/dijkstra.h"
+#include "routing/search_workspace.h"
+#include "impl/csr_graph.h"
+
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace routing {
+
+std::vector<std::string> BidirectionalAStar::GetPath(const IGraph* graph, const std::string& from, const std::string& to) const {
+    const CsrGraph* csr = dynamic_cast<const CsrGraph*>(graph);
+    if (!csr) {
+        return (guided ? AStar::Default() : Dijkstra::Instance()).GetPath(graph, from, to);
+    }
+
+    uint32_t start = csr->IndexOf(from);
+    if (start == CsrGraph::InvalidNode) {
+        throw std::invalid_argument("'from' node not found in graph: " + from);
+    }
+    uint32_t end = csr->IndexOf(to);
+    if (end == CsrGraph::InvalidNode) {
+        throw std::invalid_argument("'to' node not found in graph: " + to);
+    }
+
+    std::vector<std::string> names;
+    for (uint32_t node : GetIndexPath(*csr, start, end)) {
+        names.push_back(csr->NameOf(node));
+    }
+    return names;
+}
+
+std::vector<uint32_t> BidirectionalAStar::GetIndexPath(const CsrGraph& graph, uint32_t from, uint32_t to) const {
+    if (from >= graph.NodeCount()) {
+        throw std::invalid_argument("'from' node not found in graph: " + std::to_string(from));
+    }
+    if (to >= graph.NodeCount()) {
+        throw std::invalid_argument("'to' node not found in graph: " + std::to_string(to));
+    }
+    if (from == to) {
+        return {from};
+    }
+
+    const CsrGraph::ReverseEdges& reverse = graph.GetReverseEdges();
+    const Float3 source(graph.Position(from));
+    const Float3 target(graph.Position(to));
+
+    // potential of the forward search, the backward search uses its negation
+    auto potential = [&](uint32_t node) -> float {
+        if (!guided) {
+            return 0.0f;
+        }
+        const Float3 pos(graph.Position(node));
+        return 0.5f * (EuclideanDistance::Distance(pos, target) - EuclideanDistance::Distance(source, pos));
+    };
+
+    SearchWorkspace::Lease forward;
+    SearchWorkspace::Lease backward;
+    forward->Reset(graph.NodeCount());
+    backward->Reset(graph.NodeCount());
+    forward->Reach(from, 0, SearchWorkspace::NoParent);
+    forward->HeapPush(potential(from), from);
+    backward->Reach(to, 0, SearchWorkspace::NoParent);
+    backward->HeapPush(-potential(to), to);
+
+    const float infinity = std::numeric_limits<float>::infinity();
+    float best = infinity;
+    uint32_t meeting = CsrGraph::InvalidNode;
+    uint64_t settled = 0;
+
+    while (!forward->HeapEmpty() || !backward->HeapEmpty()) {
+        const float forwardKey = forward->HeapEmpty() ? infinity : forward->HeapTop().first;
+        const float backwardKey = backward->HeapEmpty() ? infinity : backward->HeapTop().first;
+        // no path through the unsettled nodes can be shorter than the best one
+        if (forwardKey + backwardKey >= best) {
+            break;
+        }
+
+        const bool isForward = forwardKey <= backwardKey;
+        SearchWorkspace& search = isForward ? *forward : *backward;
+        const SearchWorkspace& other = isForward ? *backward : *forward;
+
+        const uint32_t node = search.HeapPop().second;
+        if (search.Closed(node)) {
+            continue;
+        }
+        search.Close(node);
+        settled++;
+
+        const float distance = search.Distance(node);
+        if (other.Reached(node) && distance + other.Distance(node) < best) {
+            best = distance + other.Distance(node);
+            meeting = node;
+        }
+
+        const uint32_t begin = isForward ? graph.EdgeBegin(node) : reverse.offsets[node];
+        const uint32_t end = isForward ? graph.EdgeEnd(node) : reverse.offsets[node + 1];
+        for (uint32_t e = begin; e < end; e++) {
+            const uint32_t next = isForward ? graph.EdgeTarget(e) : reverse.sources[e];
+            if (search.Closed(next)) {
+                continue;
+            }
+
+            const float tentative = distance + (isForward ? graph.EdgeWeight(e) : reverse.weights[e]);
+            if (tentative < search.Distance(next)) {
+                search.Reach(next, tentative, node);
+                search.HeapPush(tentative + (isForward ? potential(next) : -potential(next)), next);
+
+                if (other.Reached(next) && tentative + other.Distance(next) < best) {
+                    best = tentative + other.Distance(next);
+                    meeting = next;
+                }
+            }
+        }
+    }
+    CountSettled(settled);
+
+    if (meeting == CsrGraph::InvalidNode) {
+        return {};
+    }
+
+    std::vector<uint32_t> path = forward->Unwind(meeting);
+    for (uint32_t node = backward->Parent(meeting); node != SearchWorkspace::NoParent; node = backward->Parent(node)) {
+        path.push_back(node);
+    }
+    return path;
+}
+
+}
@@ -0,0 +1,404 @@
+#include "routing/contraction_hierarchy.h"
+#include "routing/dijkstra.h"
+#include "routing/search_workspace.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <stdexcept>
+
+namespace routing {
+
+namespace {
+
+struct DynamicArc {
+    uint32_t node;
+    float weight;
+    uint32_t middle;
+};
+typedef std::vector< std::vector<DynamicArc> > Adjacency;
+
+// Witness searches give up after settling this many nodes; a missed witness
+// only costs an unnecessary shortcut.
+const uint32_t WitnessSettleLimit = 500;
+
+class Contractor {
+public:
+    Contractor(const CsrGraph& graph) : out(graph.NodeCount()), in(graph.NodeCount()),
+        contracted(graph.NodeCount(), false), contractedNeighbors(graph.NodeCount(), 0) {
+        for (uint32_t u = 0; u < graph.NodeCount(); u++) {
+            for (uint32_t e = graph.EdgeBegin(u); e < graph.EdgeEnd(u); e++) {
+                if (graph.EdgeTarget(e) != u) {
+                    AddArc(u, graph.EdgeTarget(e), graph.EdgeWeight(e), 0xffffffffu);
+                }
+            }
+        }
+    }
+
+    // Shortcuts that contracting v would need, adding them if 'apply'.
+    int Shortcuts(uint32_t v, bool apply) {
+        int count = 0;
+        SearchWorkspace::Lease search;
+        for (size_t i = 0; i < in[v].size(); i++) {
+            const uint32_t u = in[v][i].node;
+            const float toV = in[v][i].weight;
+
+            float limit = 0;
+            for (const DynamicArc& arc : out[v]) {
+                if (arc.node != u) {
+                    limit = std::max(limit, toV + arc.weight);
+                }
+            }
+            Witness(u, v, limit, *search);
+
+            for (size_t j = 0; j < out[v].size(); j++) {
+                const uint32_t w = out[v][j].node;
+                const float through = toV + out[v][j].weight;
+                if (w == u || search->Distance(w) <= through) {
+                    continue;
+                }
+                count++;
+                if (apply) {
+                    AddArc(u, w, through, v);
+                }
+            }
+        }
+        return count;
+    }
+
+    int Priority(uint32_t v) {
+        return Shortcuts(v, false) - static_cast<int>(in[v].size() + out[v].size()) + contractedNeighbors[v];
+    }
+
+    // Contracts v and returns the uncontracted neighbours whose priority changed.
+    std::vector<uint32_t> Contract(uint32_t v, std::vector<DynamicArc>& upward, std::vector<DynamicArc>& downward) {
+        Shortcuts(v, true);
+        contracted[v] = true;
+        upward = out[v];
+        downward = in[v];
+
+        std::vector<uint32_t> neighbors;
+        for (const DynamicArc& arc : out[v]) {
+            Remove(in[arc.node], v);
+            neighbors.push_back(arc.node);
+        }
+        for (const DynamicArc& arc : in[v]) {
+            Remove(out[arc.node], v);
+            neighbors.push_back(arc.node);
+        }
+        std::sort(neighbors.begin(), neighbors.end());
+        neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+        for (uint32_t neighbor : neighbors) {
+            contractedNeighbors[neighbor]++;
+        }
+
+        std::vector<DynamicArc>().swap(out[v]);
+        std::vector<DynamicArc>().swap(in[v]);
+        return neighbors;
+    }
+
+private:
+    void AddArc(uint32_t u, uint32_t w, float weight, uint32_t middle) {
+        for (DynamicArc& arc : out[u]) {
+            if (arc.node == w) {
+                if (arc.weight <= weight) {
+                    return;
+                }
+                arc.weight = weight;
+                arc.middle = middle;
+                for (DynamicArc& back : in[w]) {
+                    if (back.node == u) {
+                        back.weight = weight;
+                        back.middle = middle;
+                    }
+                }
+                return;
+            }
+        }
+        DynamicArc forward = {w, weight, middle};
+        DynamicArc backward = {u, weight, middle};
+        out[u].push_back(forward);
+        in[w].push_back(backward);
+    }
+
+    static void Remove(std::vector<DynamicArc>& arcs, uint32_t node) {
+        for (size_t i = 0; i < arcs.size(); i++) {
+            if (arcs[i].node == node) {
+                arcs[i] = arcs.back();
+                arcs.pop_back();
+                return;
+            }
+        }
+    }
+
+    void Witness(uint32_t source, uint32_t avoid, float limit, SearchWorkspace& search) {
+        search.Reset(static_cast<uint32_t>(out.size()));
+        search.Reach(source, 0, SearchWorkspace::NoParent);
+        search.HeapPush(0, source);
+
+        uint32_t settled = 0;
+        while (!search.HeapEmpty()) {
+            const uint32_t node = search.HeapPop().second;
+            if (search.Closed(node)) {
+                continue;
+            }
+            search.Close(node);
+
+            const float distance = search.Distance(node);
+            if (distance > limit || ++settled > WitnessSettleLimit) {
+                return;
+            }
+
+            for (const DynamicArc& arc : out[node]) {
+                if (arc.node == avoid) {
+                    continue;
+                }
+                const float tentative = distance + arc.weight;
+                if (tentative < search.Distance(arc.node)) {
+                    search.Reach(arc.node, tentative, node);
+                    search.HeapPush(tentative, arc.node);
+                }
+            }
+        }
+    }
+
+    Adjacency out;
+    Adjacency in;
+    std::vector<bool> contracted;
+    std::vector<int> contractedNeighbors;
+};
+
+}
+
+ContractionHierarchy::ContractionHierarchy(const CsrGraph& graph) : graph(graph), shortcuts(0) {
+    Contract();
+}
+
+void ContractionHierarchy::Contract() {
+    const uint32_t n = graph.NodeCount();
+    Contractor contractor(graph);
+
+    // contract the least important node first, with lazily updated priorities
+    typedef std::pair<int, uint32_t> Entry;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+    std::vector<int> priority(n);
+    for (uint32_t v = 0; v < n; v++) {
+        priority[v] = contractor.Priority(v);
+        queue.push(Entry(priority[v], v));
+    }
+
+    const uint32_t Uncontracted = 0xffffffffu;
+    rank.assign(n, Uncontracted);
+    std::vector< std::vector<DynamicArc> > upward(n);
+    std::vector< std::vector<DynamicArc> > downward(n);
+
+    uint32_t order = 0;
+    while (!queue.empty()) {
+        const Entry top = queue.top();
+        queue.pop();
+        const uint32_t v = top.second;
+        if (rank[v] != Uncontracted || top.first != priority[v]) {
+            continue;
+        }
+
+        priority[v] = contractor.Priority(v);
+        if (!queue.empty() && priority[v] > queue.top().first) {
+            queue.push(Entry(priority[v], v));
+            continue;
+        }
+
+        rank[v] = order++;
+        for (uint32_t neighbor : contractor.Contract(v, upward[v], downward[v])) {
+            priority[neighbor] = contractor.Priority(neighbor);
+            queue.push(Entry(priority[neighbor], neighbor));
+        }
+    }
+
+    upOffsets.assign(1, 0);
+    downOffsets.assign(1, 0);
+    for (uint32_t v = 0; v < n; v++) {
+        for (const DynamicArc& arc : upward[v]) {
+            Arc stored = {arc.node, arc.weight, arc.middle};
+            up.push_back(stored);
+            shortcuts += arc.middle != NoMiddle;
+        }
+        for (const DynamicArc& arc : downward[v]) {
+            Arc stored = {arc.node, arc.weight, arc.middle};
+            down.push_back(stored);
+            shortcuts += arc.middle != NoMiddle;
+        }
+        upOffsets.push_back(static_cast<uint32_t>(up.size()));
+        downOffsets.push_back(static_cast<uint32_t>(down.size()));
+    }
+}
+
+const ContractionHierarchy::Arc* ContractionHierarchy::FindArc(uint32_t from, uint32_t to) const {
+    if (rank[from] < rank[to]) {
+        for (uint32_t i = upOffsets[from]; i < upOffsets[from + 1]; i++) {
+            if (up[i].node == to) {
+                return &up[i];
+            }
+        }
+    } else {
+        for (uint32_t i = downOffsets[to]; i < downOffsets[to + 1]; i++) {
+            if (down[i].node == from) {
+                return &down[i];
+            }
+        }
+    }
+    throw std::logic_error("missing arc in contraction hierarchy");
+}
+
+void ContractionHierarchy::Unpack(uint32_t from, uint32_t to, std::vector<uint32_t>& path) const {
+    std::vector< std::pair<uint32_t, uint32_t> > pending(1, std::make_pair(from, to));
+    while (!pending.empty()) {
+        const std::pair<uint32_t, uint32_t> arc = pending.back();
+        pending.pop_back();
+
+        const uint32_t middle = FindArc(arc.first, arc.second)->middle;
+        if (middle == NoMiddle) {
+            path.push_back(arc.second);
+        } else {
+            pending.push_back(std::make_pair(middle, arc.second));
+            pending.push_back(std::make_pair(arc.first, middle));
+        }
+    }
+}
+
+std::vector<std::string> ContractionHierarchy::GetPath(const IGraph* g, const std::string& from, const std::string& to) const {
+    if (g != &graph) {
+        return Dijkstra::Instance().GetPath(g, from, to);
+    }
+
+    const uint32_t start = graph.IndexOf(from);
+    if (start == CsrGraph::InvalidNode) {
+        throw std::invalid_argument("'from' node not found in graph: " + from);
+    }
+    const uint32_t end = graph.IndexOf(to);
+    if (end == CsrGraph::InvalidNode) {
+        throw std::invalid_argument("'to' node not found in graph: " + to);
+    }
+
+    std::vector<std::string> names;
+    for (uint32_t node : GetIndexPath(graph, start, end)) {
+        names.push_back(graph.NameOf(node));
+    }
+    return names;
+}
+
+std::vector<uint32_t> ContractionHierarchy::GetIndexPath(const CsrGraph& g, uint32_t from, uint32_t to) const {
+    if (&g != &graph) {
+        return Dijkstra::Instance().GetIndexPath(g, from, to);
+    }
+    if (from >= graph.NodeCount()) {
+        throw std::invalid_argument("'from' node not found in graph: " + std::to_string(from));
+    }
+    if (to >= graph.NodeCount()) {
+        throw std::invalid_argument("'to' node not found in graph: " + std::to_string(to));
+    }
+    if (from == to) {
+        return {from};
+    }
+
+    SearchWorkspace::Lease forward;
+    SearchWorkspace::Lease backward;
+    forward->Reset(graph.NodeCount());
+    backward->Reset(graph.NodeCount());
+    forward->Reach(from, 0, SearchWorkspace::NoParent);
+    forward->HeapPush(0, from);
+    backward->Reach(to, 0, SearchWorkspace::NoParent);
+    backward->HeapPush(0, to);
+
+    const float infinity = std::numeric_limits<float>::infinity();
+    float best = infinity;
+    uint32_t meeting = CsrGraph::InvalidNode;
+    uint64_t settled = 0;
+
+    while (!forward->HeapEmpty() || !backward->HeapEmpty()) {
+        const float forwardKey = forward->HeapEmpty() ? infinity : forward->HeapTop().first;
+        const float backwardKey = backward->HeapEmpty() ? infinity : backward->HeapTop().first;
+        if (std::min(forwardKey, backwardKey) >= best) {
+            break;
+        }
+
+        // advance whichever side is closer to its source
+        const bool isForward = forwardKey <= backwardKey;
+        SearchWorkspace& search = isForward ? *forward : *backward;
+        const SearchWorkspace& other = isForward ? *backward : *forward;
+
+        const uint32_t node = search.HeapPop().second;
+        if (search.Closed(node)) {
+            continue;
+        }
+        search.Close(node);
+        settled++;
+
+        const float distance = search.Distance(node);
+        if (other.Reached(node) && distance + other.Distance(node) < best) {
+            best = distance + other.Distance(node);
+            meeting = node;
+        }
+
+        const std::vector<uint32_t>& offsets = isForward ? upOffsets : downOffsets;
+        const std::vector<Arc>& arcs = isForward ? up : down;
+        for (uint32_t i = offsets[node]; i < offsets[node + 1]; i++) {
+            const float tentative = distance + arcs[i].weight;
+            if (tentative < search.Distance(arcs[i].node)) {
+                search.Reach(arcs[i].node, tentative, node);
+                search.HeapPush(tentative, arcs[i].node);
+            }
+        }
+    }
+    CountSettled(settled);
+
+    if (meeting == CsrGraph::InvalidNode) {
+        return {};
+    }
+
+    std::vector<uint32_t> upward = forward->Unwind(meeting);
+    std::vector<uint32_t> path(1, from);
+    for (size_t i = 1; i < upward.size(); i++) {
+        Unpack(upward[i - 1], upward[i], path);
+    }
+    for (uint32_t node = meeting; node != to; node = backward->Parent(node)) {
+        Unpack(node, backward->Parent(node), path);
+    }
+    return path;
+}
+
+std::vector< std::pair<uint32_t, float> > ContractionHierarchy::SearchSpace(uint32_t node, bool forward) const {
+    if (node >= graph.NodeCount()) {
+        throw std::invalid_argument("node not found in graph: " + std::to_string(node));
+    }
+
+    SearchWorkspace::Lease search;
+    search->Reset(graph.NodeCount());
+    search->Reach(node, 0, SearchWorkspace::NoParent);
+    search->HeapPush(0, node);
+
+    const std::vector<uint32_t>& offsets = forward ? upOffsets : downOffsets;
+    const std::vector<Arc>& arcs = forward ? up : down;
+    std::vector< std::pair<uint32_t, float> > space;
+    while (!search->HeapEmpty()) {
+        const uint32_t next = search->HeapPop().second;
+        if (search->Closed(next)) {
+            continue;
+        }
+        search->Close(next);
+
+        const float distance = search->Distance(next);
+        space.emplace_back(next, distance);
+        for (uint32_t i = offsets[next]; i < offsets[next + 1]; i++) {
+            const float tentative = distance + arcs[i].weight;
+            if (tentative < search->Distance(arcs[i].node)) {
+                search->Reach(arcs[i].node, tentative, next);
+                search->HeapPush(tentative, arcs[i].node);
+            }
+        }
+    }
+    CountSettled(space.size());
+    return space;
+}
+
+}
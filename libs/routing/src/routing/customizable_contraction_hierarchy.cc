@@ -0,0 +1,506 @@
+#include "routing/customizable_contraction_hierarchy.h"
+#include "routing/dijkstra.h"
+#include "routing/search_workspace.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <queue>
+#include <stdexcept>
+
+namespace routing {
+
+namespace {
+
+// Cells of at most this many nodes are not cut any further.
+const size_t CellSize = 4;
+
+}
+
+CustomizableContractionHierarchy::CustomizableContractionHierarchy(const CsrGraph& graph) : graph(graph) {
+    Dissect();
+    Contract();
+
+    std::shared_ptr<Metric> initial(new Metric());
+    initial->version = 0;
+    initial->changed = 0;
+    initial->edges.resize(graph.EdgeCount());
+    for (uint32_t e = 0; e < graph.EdgeCount(); e++) {
+        initial->edges[e] = graph.EdgeWeight(e);
+    }
+    CustomizeAll(*initial);
+    Publish(initial);
+}
+
+// Each cell is cut in two at the median of its widest axis.  The nodes on
+// the side with the shorter boundary that have a neighbour on the other side
+// form the separator, which is ranked above both halves, so ranks are handed
+// out from the top.
+void CustomizableContractionHierarchy::Dissect() {
+    const uint32_t n = graph.NodeCount();
+    std::vector< std::vector<uint32_t> > neighbors(n);
+    for (uint32_t u = 0; u < n; u++) {
+        for (uint32_t e = graph.EdgeBegin(u); e < graph.EdgeEnd(u); e++) {
+            const uint32_t v = graph.EdgeTarget(e);
+            if (v != u) {
+                neighbors[u].push_back(v);
+                neighbors[v].push_back(u);
+            }
+        }
+    }
+
+    std::vector<uint32_t> cell(n, 0);
+    uint32_t cells = 1;
+    std::vector<uint32_t> descending;
+    descending.reserve(n);
+    std::vector< std::vector<uint32_t> > pending(1, std::vector<uint32_t>(n));
+    std::iota(pending[0].begin(), pending[0].end(), 0);
+    while (!pending.empty()) {
+        std::vector<uint32_t> nodes;
+        nodes.swap(pending.back());
+        pending.pop_back();
+        if (nodes.size() <= CellSize) {
+            descending.insert(descending.end(), nodes.begin(), nodes.end());
+            continue;
+        }
+
+        float low[3], high[3];
+        std::copy(graph.Position(nodes[0]), graph.Position(nodes[0]) + 3, low);
+        std::copy(graph.Position(nodes[0]), graph.Position(nodes[0]) + 3, high);
+        for (uint32_t v : nodes) {
+            for (int j = 0; j < 3; j++) {
+                low[j] = std::min(low[j], graph.Position(v)[j]);
+                high[j] = std::max(high[j], graph.Position(v)[j]);
+            }
+        }
+        int axis = 0;
+        for (int j = 1; j < 3; j++) {
+            if (high[j] - low[j] > high[axis] - low[axis]) {
+                axis = j;
+            }
+        }
+
+        const size_t half = nodes.size() / 2;
+        std::nth_element(nodes.begin(), nodes.begin() + half, nodes.end(), [&](uint32_t a, uint32_t b) {
+            return graph.Position(a)[axis] < graph.Position(b)[axis];
+        });
+        const uint32_t sides[2] = {cells, cells + 1};
+        cells += 2;
+        for (size_t i = 0; i < nodes.size(); i++) {
+            cell[nodes[i]] = sides[i < half ? 0 : 1];
+        }
+
+        std::vector<uint32_t> boundary[2];
+        for (uint32_t v : nodes) {
+            const int side = cell[v] == sides[0] ? 0 : 1;
+            for (uint32_t w : neighbors[v]) {
+                if (cell[w] == sides[1 - side]) {
+                    boundary[side].push_back(v);
+                    break;
+                }
+            }
+        }
+        const std::vector<uint32_t>& separator = boundary[boundary[0].size() <= boundary[1].size() ? 0 : 1];
+        for (uint32_t v : separator) {
+            cell[v] = cells;
+        }
+        cells++;
+        descending.insert(descending.end(), separator.begin(), separator.end());
+
+        std::vector<uint32_t> parts[2];
+        for (uint32_t v : nodes) {
+            if (cell[v] == sides[0]) {
+                parts[0].push_back(v);
+            } else if (cell[v] == sides[1]) {
+                parts[1].push_back(v);
+            }
+        }
+        pending.push_back(std::move(parts[0]));
+        pending.push_back(std::move(parts[1]));
+    }
+
+    order.assign(descending.rbegin(), descending.rend());
+    rank.resize(n);
+    for (uint32_t r = 0; r < n; r++) {
+        rank[order[r]] = r;
+    }
+}
+
+// Eliminating the nodes in rank order joins the upper neighbours of each one
+// into a clique.  They all become upper neighbours of the lowest of them, its
+// parent, so passing them on to the parent adds every shortcut.
+void CustomizableContractionHierarchy::Contract() {
+    const uint32_t n = graph.NodeCount();
+    std::vector< std::vector<uint32_t> > upper(n);
+    for (uint32_t u = 0; u < n; u++) {
+        for (uint32_t e = graph.EdgeBegin(u); e < graph.EdgeEnd(u); e++) {
+            const uint32_t v = graph.EdgeTarget(e);
+            if (v != u) {
+                upper[rank[u] < rank[v] ? u : v].push_back(rank[u] < rank[v] ? v : u);
+            }
+        }
+    }
+
+    parent.assign(n, CsrGraph::InvalidNode);
+    for (uint32_t v : order) {
+        std::vector<uint32_t>& above = upper[v];
+        std::sort(above.begin(), above.end());
+        above.erase(std::unique(above.begin(), above.end()), above.end());
+        if (above.empty()) {
+            continue;
+        }
+        parent[v] = *std::min_element(above.begin(), above.end(), [&](uint32_t a, uint32_t b) { return rank[a] < rank[b]; });
+        for (uint32_t w : above) {
+            if (w != parent[v]) {
+                upper[parent[v]].push_back(w);
+            }
+        }
+    }
+
+    arcOffsets.assign(1, 0);
+    for (uint32_t u = 0; u < n; u++) {
+        for (uint32_t w : upper[u]) {
+            tails.push_back(u);
+            heads.push_back(w);
+        }
+        arcOffsets.push_back(static_cast<uint32_t>(heads.size()));
+        std::vector<uint32_t>().swap(upper[u]);
+    }
+
+    lowerOffsets.assign(n + 1, 0);
+    for (uint32_t head : heads) {
+        lowerOffsets[head + 1]++;
+    }
+    for (uint32_t v = 0; v < n; v++) {
+        lowerOffsets[v + 1] += lowerOffsets[v];
+    }
+    lowerArcs.resize(heads.size());
+    std::vector<uint32_t> next(lowerOffsets.begin(), lowerOffsets.end() - 1);
+    for (uint32_t a = 0; a < heads.size(); a++) {
+        lowerArcs[next[heads[a]]++] = a;
+    }
+
+    edgeArcs.assign(graph.EdgeCount(), CsrGraph::InvalidNode);
+    for (uint32_t u = 0; u < n; u++) {
+        for (uint32_t e = graph.EdgeBegin(u); e < graph.EdgeEnd(u); e++) {
+            const uint32_t v = graph.EdgeTarget(e);
+            if (v != u) {
+                edgeArcs[e] = rank[u] < rank[v] ? FindArc(u, v) : FindArc(v, u);
+            }
+        }
+    }
+}
+
+uint32_t CustomizableContractionHierarchy::FindArc(uint32_t low, uint32_t high) const {
+    const uint32_t* begin = heads.data() + arcOffsets[low];
+    const uint32_t* end = heads.data() + arcOffsets[low + 1];
+    const uint32_t* found = std::lower_bound(begin, end, high);
+    if (found == end || *found != high) {
+        throw std::logic_error("missing arc in customizable contraction hierarchy");
+    }
+    return static_cast<uint32_t>(found - heads.data());
+}
+
+bool CustomizableContractionHierarchy::Customize(Metric& metric, uint32_t a) const {
+    const uint32_t x = tails[a];
+    const uint32_t y = heads[a];
+    float up = std::numeric_limits<float>::infinity();
+    float down = up;
+    uint32_t upMiddle = NoMiddle;
+    uint32_t downMiddle = NoMiddle;
+    for (uint32_t e = graph.EdgeBegin(x); e < graph.EdgeEnd(x); e++) {
+        if (graph.EdgeTarget(e) == y) {
+            up = std::min(up, metric.edges[e]);
+        }
+    }
+    for (uint32_t e = graph.EdgeBegin(y); e < graph.EdgeEnd(y); e++) {
+        if (graph.EdgeTarget(e) == x) {
+            down = std::min(down, metric.edges[e]);
+        }
+    }
+
+    // the lower triangles x - v - y, from the arcs into x and y
+    uint32_t i = lowerOffsets[x];
+    uint32_t j = lowerOffsets[y];
+    while (i < lowerOffsets[x + 1] && j < lowerOffsets[y + 1]) {
+        const uint32_t toX = lowerArcs[i];
+        const uint32_t toY = lowerArcs[j];
+        if (tails[toX] < tails[toY]) {
+            i++;
+        } else if (tails[toX] > tails[toY]) {
+            j++;
+        } else {
+            const float through = metric.down[toX] + metric.up[toY];
+            if (through < up) {
+                up = through;
+                upMiddle = tails[toX];
+            }
+            const float back = metric.down[toY] + metric.up[toX];
+            if (back < down) {
+                down = back;
+                downMiddle = tails[toX];
+            }
+            i++;
+            j++;
+        }
+    }
+
+    if (up == metric.up[a] && down == metric.down[a] && upMiddle == metric.upMiddle[a] && downMiddle == metric.downMiddle[a]) {
+        return false;
+    }
+    metric.up[a] = up;
+    metric.down[a] = down;
+    metric.upMiddle[a] = upMiddle;
+    metric.downMiddle[a] = downMiddle;
+    return true;
+}
+
+// An arc only depends on arcs from lower ranked tails, so the tails are
+// customized from the bottom up.
+void CustomizableContractionHierarchy::CustomizeAll(Metric& metric) const {
+    metric.up.assign(heads.size(), std::numeric_limits<float>::infinity());
+    metric.down.assign(heads.size(), std::numeric_limits<float>::infinity());
+    metric.upMiddle.assign(heads.size(), NoMiddle);
+    metric.downMiddle.assign(heads.size(), NoMiddle);
+    for (uint32_t v : order) {
+        for (uint32_t a = arcOffsets[v]; a < arcOffsets[v + 1]; a++) {
+            Customize(metric, a);
+        }
+    }
+}
+
+std::shared_ptr<const CustomizableContractionHierarchy::Metric> CustomizableContractionHierarchy::GetMetric() const {
+    std::lock_guard<std::mutex> lock(metricMutex);
+    return metric;
+}
+
+void CustomizableContractionHierarchy::Publish(std::shared_ptr<const Metric> next) {
+    std::lock_guard<std::mutex> lock(metricMutex);
+    metric = next;
+}
+
+void CustomizableContractionHierarchy::SetEdgeWeights(const std::vector<float>& weights) {
+    if (weights.size() != graph.EdgeCount()) {
+        throw std::invalid_argument("expected " + std::to_string(graph.EdgeCount()) + " edge weights, got " + std::to_string(weights.size()));
+    }
+
+    std::lock_guard<std::mutex> lock(customizeMutex);
+    std::shared_ptr<Metric> next(new Metric());
+    next->version = GetMetric()->version + 1;
+    next->changed = 0;
+    next->edges = weights;
+    for (uint32_t e = 0; e < graph.EdgeCount(); e++) {
+        next->changed += weights[e] != graph.EdgeWeight(e);
+    }
+    CustomizeAll(*next);
+    Publish(next);
+}
+
+void CustomizableContractionHierarchy::ResetEdgeWeights() {
+    std::vector<float> weights(graph.EdgeCount());
+    for (uint32_t e = 0; e < graph.EdgeCount(); e++) {
+        weights[e] = graph.EdgeWeight(e);
+    }
+    SetEdgeWeights(weights);
+}
+
+// The arcs whose triangles include a changed arc x - y are the arcs y - c
+// for the other upper neighbours c of x.  Such an arc only changes if the
+// triangle through x now beats it or was its shortest way before, and the
+// arcs that may change are recomputed in order of their tails' ranks, each
+// once its lower arcs are final.
+void CustomizableContractionHierarchy::UpdateEdges(const std::vector<EdgeUpdate>& updates) {
+    std::vector<uint32_t> edges;
+    for (const EdgeUpdate& update : updates) {
+        uint32_t edge = CsrGraph::InvalidNode;
+        if (update.from < graph.NodeCount() && update.to < graph.NodeCount()) {
+            for (uint32_t e = graph.EdgeBegin(update.from); e < graph.EdgeEnd(update.from); e++) {
+                if (graph.EdgeTarget(e) == update.to) {
+                    edge = e;
+                    break;
+                }
+            }
+        }
+        if (edge == CsrGraph::InvalidNode) {
+            throw std::invalid_argument("no edge from " + std::to_string(update.from) + " to " + std::to_string(update.to));
+        }
+        edges.push_back(edge);
+    }
+
+    std::lock_guard<std::mutex> lock(customizeMutex);
+    std::shared_ptr<Metric> next(new Metric(*GetMetric()));
+    next->version++;
+
+    typedef std::pair<uint32_t, uint32_t> Entry;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+    for (size_t i = 0; i < edges.size(); i++) {
+        const uint32_t e = edges[i];
+        next->changed -= next->edges[e] != graph.EdgeWeight(e);
+        next->changed += updates[i].weight != graph.EdgeWeight(e);
+        next->edges[e] = updates[i].weight;
+        if (edgeArcs[e] != CsrGraph::InvalidNode) {
+            queue.push(Entry(rank[tails[edgeArcs[e]]], edgeArcs[e]));
+        }
+    }
+
+    uint32_t last = CsrGraph::InvalidNode;
+    while (!queue.empty()) {
+        const uint32_t a = queue.top().second;
+        queue.pop();
+        if (a == last || !Customize(*next, a)) {
+            last = a;
+            continue;
+        }
+        last = a;
+
+        const uint32_t x = tails[a];
+        const uint32_t y = heads[a];
+        for (uint32_t b = arcOffsets[x]; b < arcOffsets[x + 1]; b++) {
+            const uint32_t c = heads[b];
+            if (c == y) {
+                continue;
+            }
+            const bool yLower = rank[y] < rank[c];
+            const uint32_t above = yLower ? FindArc(y, c) : FindArc(c, y);
+            const uint32_t toLow = yLower ? a : b;
+            const uint32_t toHigh = yLower ? b : a;
+            if (next->upMiddle[above] == x || next->downMiddle[above] == x
+                || next->down[toLow] + next->up[toHigh] < next->up[above]
+                || next->down[toHigh] + next->up[toLow] < next->down[above]) {
+                queue.push(Entry(rank[tails[above]], above));
+            }
+        }
+    }
+    Publish(next);
+}
+
+float CustomizableContractionHierarchy::EdgeWeight(uint32_t edge) const {
+    return GetMetric()->edges.at(edge);
+}
+
+std::string CustomizableContractionHierarchy::GetName() const {
+    return GetMetric()->changed == 0 ? "cch" : "";
+}
+
+uint64_t CustomizableContractionHierarchy::MetricVersion() const {
+    return GetMetric()->version;
+}
+
+void CustomizableContractionHierarchy::Unpack(const Metric& metric, uint32_t from, uint32_t to, std::vector<uint32_t>& path) const {
+    std::vector< std::pair<uint32_t, uint32_t> > pending(1, std::make_pair(from, to));
+    while (!pending.empty()) {
+        const std::pair<uint32_t, uint32_t> arc = pending.back();
+        pending.pop_back();
+
+        const uint32_t middle = rank[arc.first] < rank[arc.second]
+            ? metric.upMiddle[FindArc(arc.first, arc.second)]
+            : metric.downMiddle[FindArc(arc.second, arc.first)];
+        if (middle == NoMiddle) {
+            path.push_back(arc.second);
+        } else {
+            pending.push_back(std::make_pair(middle, arc.second));
+            pending.push_back(std::make_pair(arc.first, middle));
+        }
+    }
+}
+
+std::vector<std::string> CustomizableContractionHierarchy::GetPath(const IGraph* g, const std::string& from, const std::string& to) const {
+    if (g != &graph) {
+        return Dijkstra::Instance().GetPath(g, from, to);
+    }
+
+    const uint32_t start = graph.IndexOf(from);
+    if (start == CsrGraph::InvalidNode) {
+        throw std::invalid_argument("'from' node not found in graph: " + from);
+    }
+    const uint32_t end = graph.IndexOf(to);
+    if (end == CsrGraph::InvalidNode) {
+        throw std::invalid_argument("'to' node not found in graph: " + to);
+    }
+
+    std::vector<std::string> names;
+    for (uint32_t node : GetIndexPath(graph, start, end)) {
+        names.push_back(graph.NameOf(node));
+    }
+    return names;
+}
+
+// Every node either search reaches is an ancestor of its start in the
+// elimination tree, so walking the ancestors in order and relaxing their
+// upper arcs settles each one after all the nodes that lead to it.
+std::vector<uint32_t> CustomizableContractionHierarchy::GetIndexPath(const CsrGraph& g, uint32_t from, uint32_t to) const {
+    if (&g != &graph) {
+        return Dijkstra::Instance().GetIndexPath(g, from, to);
+    }
+    if (from >= graph.NodeCount()) {
+        throw std::invalid_argument("'from' node not found in graph: " + std::to_string(from));
+    }
+    if (to >= graph.NodeCount()) {
+        throw std::invalid_argument("'to' node not found in graph: " + std::to_string(to));
+    }
+    if (from == to) {
+        return {from};
+    }
+
+    std::shared_ptr<const Metric> current = GetMetric();
+    const Metric& m = *current;
+    SearchWorkspace::Lease forward;
+    SearchWorkspace::Lease backward;
+    forward->Reset(graph.NodeCount());
+    backward->Reset(graph.NodeCount());
+    forward->Reach(from, 0, SearchWorkspace::NoParent);
+    backward->Reach(to, 0, SearchWorkspace::NoParent);
+
+    uint64_t settled = 0;
+    for (uint32_t v = from; v != CsrGraph::InvalidNode; v = parent[v]) {
+        settled++;
+        if (!forward->Reached(v)) {
+            continue;
+        }
+        const float distance = forward->Distance(v);
+        for (uint32_t a = arcOffsets[v]; a < arcOffsets[v + 1]; a++) {
+            const float tentative = distance + m.up[a];
+            if (tentative < forward->Distance(heads[a])) {
+                forward->Reach(heads[a], tentative, v);
+            }
+        }
+    }
+
+    float best = std::numeric_limits<float>::infinity();
+    uint32_t meeting = CsrGraph::InvalidNode;
+    for (uint32_t v = to; v != CsrGraph::InvalidNode; v = parent[v]) {
+        settled++;
+        if (!backward->Reached(v)) {
+            continue;
+        }
+        const float distance = backward->Distance(v);
+        if (forward->Reached(v) && distance + forward->Distance(v) < best) {
+            best = distance + forward->Distance(v);
+            meeting = v;
+        }
+        for (uint32_t a = arcOffsets[v]; a < arcOffsets[v + 1]; a++) {
+            const float tentative = distance + m.down[a];
+            if (tentative < backward->Distance(heads[a])) {
+                backward->Reach(heads[a], tentative, v);
+            }
+        }
+    }
+    CountSettled(settled);
+
+    if (meeting == CsrGraph::InvalidNode) {
+        return {};
+    }
+
+    std::vector<uint32_t> upward = forward->Unwind(meeting);
+    std::vector<uint32_t> path(1, from);
+    for (size_t i = 1; i < upward.size(); i++) {
+        Unpack(m, upward[i - 1], upward[i], path);
+    }
+    for (uint32_t node = meeting; node != to; node = backward->Parent(node)) {
+        Unpack(m, node, backward->Parent(node), path);
+    }
+    return path;
+}
+
+}
@@ -0,0 +1,184 @@
+#include "routing/distance_matrix.h"
+#include "routing/dijkstra.h"
+#include "routing/search_workspace.h"
+#include "util/parallel_for.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace routing {
+
+namespace {
+
+std::vector<uint32_t> Snap(const CsrGraph& graph, const std::vector< std::vector<float> >& points) {
+    std::vector<uint32_t> nodes;
+    nodes.reserve(points.size());
+    for (std::vector<float> point : points) {
+        point.resize(3, 0.0f);
+        nodes.push_back(graph.NearestIndex(point.data()));
+    }
+    return nodes;
+}
+
+}
+
+DistanceMatrix::DistanceMatrix(const IGraph& graph, const std::vector< std::vector<float> >& sources,
+                               const std::vector< std::vector<float> >& targets,
+                               const ContractionHierarchy* hierarchy, unsigned threads)
+    : graph(graph), hierarchy(hierarchy), sources(sources), targets(targets),
+      distances(sources.size() * targets.size(), std::numeric_limits<float>::infinity()) {
+    if (distances.empty() || graph.GetNodes().empty()) {
+        return;
+    }
+
+    // every GraphBase searches on a CsrGraph of its own nodes, at the same
+    // positions, so the shared searches work for any of them
+    const GraphBase* base = dynamic_cast<const GraphBase*>(&graph);
+    const CsrGraph* csr = base ? &base->GetRoutingGraph() : NULL;
+    if (csr && hierarchy && &hierarchy->GetGraph() == csr) {
+        FromHierarchy(*hierarchy, threads);
+    }
+    else if (csr) {
+        // a hierarchy of another graph is no use for this one
+        this->hierarchy = NULL;
+        FromCsrGraph(*csr, threads);
+    }
+    else {
+        this->hierarchy = NULL;
+        FromGraph(threads);
+    }
+}
+
+std::vector< std::vector<float> > DistanceMatrix::GetPath(size_t source, size_t target) const {
+    if (source >= sources.size() || target >= targets.size()) {
+        throw std::out_of_range("no such entry in the distance matrix");
+    }
+    const RoutingStrategy& strategy = hierarchy ? static_cast<const RoutingStrategy&>(*hierarchy) : Dijkstra::Instance();
+    return graph.GetPath(sources[source], targets[target], strategy);
+}
+
+void DistanceMatrix::FromHierarchy(const ContractionHierarchy& hierarchy, unsigned threads) {
+    const CsrGraph& csr = hierarchy.GetGraph();
+    const std::vector<uint32_t> from = Snap(csr, sources);
+    const std::vector<uint32_t> to = Snap(csr, targets);
+
+    std::vector< std::vector< std::pair<uint32_t, float> > > spaces(to.size());
+    ParallelFor(to.size(), threads, [&](size_t j) {
+        spaces[j] = hierarchy.SearchSpace(to[j], false);
+    });
+
+    // bucket[offsets[v]..offsets[v+1]-1] holds (target, distance from v) for
+    // every target whose backward search settled v
+    std::vector<uint32_t> offsets(csr.NodeCount() + 1, 0);
+    for (const auto& space : spaces) {
+        for (const auto& entry : space) {
+            offsets[entry.first + 1]++;
+        }
+    }
+    for (uint32_t v = 0; v < csr.NodeCount(); v++) {
+        offsets[v + 1] += offsets[v];
+    }
+    std::vector< std::pair<uint32_t, float> > buckets(offsets.back());
+    std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+    for (uint32_t j = 0; j < spaces.size(); j++) {
+        for (const auto& entry : spaces[j]) {
+            buckets[fill[entry.first]++] = std::make_pair(j, entry.second);
+        }
+        std::vector< std::pair<uint32_t, float> >().swap(spaces[j]);
+    }
+
+    ParallelFor(from.size(), threads, [&](size_t i) {
+        float* row = &distances[i * to.size()];
+        for (const auto& entry : hierarchy.SearchSpace(from[i], true)) {
+            for (uint32_t b = offsets[entry.first]; b < offsets[entry.first + 1]; b++) {
+                row[buckets[b].first] = std::min(row[buckets[b].first], entry.second + buckets[b].second);
+            }
+        }
+    });
+}
+
+void DistanceMatrix::FromCsrGraph(const CsrGraph& csr, unsigned threads) {
+    const std::vector<uint32_t> from = Snap(csr, sources);
+    const std::vector<uint32_t> to = Snap(csr, targets);
+    std::vector<uint32_t> goals(to);
+    std::sort(goals.begin(), goals.end());
+    goals.erase(std::unique(goals.begin(), goals.end()), goals.end());
+
+    ParallelFor(from.size(), threads, [&](size_t i) {
+        SearchWorkspace::Lease search;
+        search->Reset(csr.NodeCount());
+        search->Reach(from[i], 0, SearchWorkspace::NoParent);
+        search->HeapPush(0, from[i]);
+
+        size_t remaining = goals.size();
+        uint64_t settled = 0;
+        while (remaining > 0 && !search->HeapEmpty()) {
+            const uint32_t node = search->HeapPop().second;
+            if (search->Closed(node)) {
+                continue;
+            }
+            search->Close(node);
+            settled++;
+            if (std::binary_search(goals.begin(), goals.end(), node)) {
+                remaining--;
+            }
+
+            const float distance = search->Distance(node);
+            for (uint32_t e = csr.EdgeBegin(node); e < csr.EdgeEnd(node); e++) {
+                const float tentative = distance + csr.EdgeWeight(e);
+                if (tentative < search->Distance(csr.EdgeTarget(e))) {
+                    search->Reach(csr.EdgeTarget(e), tentative, node);
+                    search->HeapPush(tentative, csr.EdgeTarget(e));
+                }
+            }
+        }
+
+        float* row = &distances[i * to.size()];
+        for (size_t j = 0; j < to.size(); j++) {
+            if (search->Closed(to[j])) {
+                row[j] = search->Distance(to[j]);
+            }
+        }
+    });
+}
+
+// A graph that is not a GraphBase has no integer ids to search over, so
+// every entry is a Dijkstra query of its own.
+void DistanceMatrix::FromGraph(unsigned threads) {
+    std::vector<const IGraphNode*> from(sources.size());
+    std::vector<const IGraphNode*> to(targets.size());
+    for (size_t i = 0; i < sources.size(); i++) {
+        from[i] = graph.NearestNode(sources[i], EuclideanDistance());
+    }
+    for (size_t j = 0; j < targets.size(); j++) {
+        to[j] = graph.NearestNode(targets[j], EuclideanDistance());
+    }
+
+    ParallelFor(distances.size(), threads, [&](size_t k) {
+        const size_t i = k / to.size();
+        const size_t j = k % to.size();
+        std::vector<std::string> path = Dijkstra::Instance().GetPath(&graph, from[i]->GetName(), to[j]->GetName());
+        if (path.empty()) {
+            return;
+        }
+        // the sum of the edge weights the search went by
+        float length = 0;
+        const IGraphNode* previous = graph.GetNode(path[0]);
+        for (size_t n = 1; n < path.size(); n++) {
+            const IGraphNode* node = graph.GetNode(path[n]);
+            for (const WeightedNeighbor& edge : previous->WeightedNeighbors()) {
+                if (edge.node == node) {
+                    length += edge.weight;
+                    break;
+                }
+            }
+            previous = node;
+        }
+        distances[k] = length;
+    });
+}
+
+}
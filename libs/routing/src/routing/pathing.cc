@@ -1,13 +1,18 @@
 #include "routing/astar.h"
 #include "routing/depth_first_search.h"
 #include "routing/breadth_first_search.h"
+#include "routing/search_workspace.h"
+#include "impl/csr_graph.h"
 
+#include <algorithm>
 #include <stdexcept>
+#include <unordered_map>
 #include <unordered_set>
 #include <queue>
-#include <tuple>
 #include <iostream>
 #include <functional>
+#include <limits>
+#include <typeinfo>
 #include <vector>
 
 using namespace std;
@@ -19,199 +24,320 @@ AStar::~AStar() {
     delete heuristic;
 }
 
-template <class T>
-class FStack {
-    public:
-        FStack() {};
-        FStack(T elem) : elem(elem), stack(NULL) { };
-        FStack(T elem, const FStack* stack) : elem(elem), stack(stack) { };
-
-        FStack* Push(T elem) const {
-            return new FStack<T>(elem, this);
-        };
-        T Top() const {
-            return elem;
-        };
-        vector<T>* ToList() const {
-            vector<T>* result;
-            if (stack) {
-                result = stack->ToList();
-            } else {
-                result = new vector<T>();
-            }
-            result->push_back(elem);
-            return result;
-        }
+// Resolves the names of a string based query against a CsrGraph so that the
+// integer search can be used instead.
+static uint32_t indexOrThrow(const CsrGraph& graph, const string& name, const string& which) {
+    uint32_t node = graph.IndexOf(name);
+    if (node == CsrGraph::InvalidNode) {
+        throw invalid_argument("'" + which + "' node not found in graph: " + name);
+    }
+    return node;
+}
+
+static void checkIndex(const CsrGraph& graph, uint32_t node, const string& which) {
+    if (node >= graph.NodeCount()) {
+        throw invalid_argument("'" + which + "' node not found in graph: " + to_string(node));
+    }
+}
+
+static vector<string> toNames(const CsrGraph& graph, const vector<uint32_t>& path) {
+    vector<string> names;
+    names.reserve(path.size());
+    for (uint32_t node : path) {
+        names.push_back(graph.NameOf(node));
+    }
+    return names;
+}
+
+typedef unordered_map<const IGraphNode*, const IGraphNode*> ParentMap;
+
+// Walks the parent links of a pointer based search back from 'last'.
+static vector<string> unwindNames(const ParentMap& parent, const IGraphNode* last) {
+    vector<string> path;
+    for (const IGraphNode* node = last; node; node = parent.at(node)) {
+        path.push_back(node->GetName());
+    }
+    return vector<string>(path.rbegin(), path.rend());
+}
 
-        T elem;
-        const FStack* stack;
+static void checkNodes(const IGraph* graph, const string& from, const string& to,
+                       const IGraphNode** start_node, const IGraphNode** terminal_node) {
+    *start_node = graph->GetNode(from);
+    if (!*start_node) {
+        throw invalid_argument("'from' node not found in graph: " + from);
+    }
+
+    *terminal_node = graph->GetNode(to);
+    if (!*terminal_node) {
+        throw invalid_argument("'to' node not found in graph: " + to);
+    }
+}
+
+// Cost and heuristic policies of the CsrGraph search.  The built-in distances
+// are called through their static Distance, anything else through the
+// virtual DistanceFunction.
+namespace {
+
+// the precomputed edge weights, which are euclidean
+struct EdgeWeight {
+    float operator()(const CsrGraph& graph, uint32_t edge, uint32_t from, uint32_t to) const {
+        return graph.EdgeWeight(edge);
+    }
 };
 
+struct VirtualCost {
+    const DistanceFunction* distance;
+    float operator()(const CsrGraph& graph, uint32_t edge, uint32_t from, uint32_t to) const {
+        return distance->Between(Float3(graph.Position(from)), Float3(graph.Position(to)));
+    }
+};
 
-struct CandidatePath {
-    CandidatePath(FStack<string>* path, float distance = 0, float estimate = 0)
-        : path(path), distance(distance), estimate(estimate) { };
-    FStack<string>* path;
-    float distance;
-    float estimate;
+template <class Distance>
+struct StaticHeuristic {
+    float operator()(const Float3& a, const Float3& b) const { return Distance::Distance(a, b); }
 };
 
-bool compareCandidatePaths(const CandidatePath* path1, const CandidatePath* path2) {
-    return (path1->distance + path1->estimate) > (path2->distance + path2->estimate);
+struct VirtualHeuristic {
+    const DistanceFunction* distance;
+    float operator()(const Float3& a, const Float3& b) const { return distance->Between(a, b); }
 };
 
-vector<string> AStar::GetPath(const IGraph* graph, const std::string& from, const std::string& to) const {
+}
 
-    const IGraphNode* start_node = graph->GetNode(from);
-    // only here for debugging
-    if(!start_node) {
-        throw invalid_argument("'from' node not found in graph: " + from);
+vector<uint32_t> AStar::GetIndexPath(const CsrGraph& graph, uint32_t from, uint32_t to) const {
+    checkIndex(graph, from, "from");
+    checkIndex(graph, to, "to");
+
+    if (typeid(*cost) == typeid(EuclideanDistance)) {
+        return SearchWith(graph, from, to, EdgeWeight());
     }
+    return SearchWith(graph, from, to, VirtualCost{cost});
+}
 
-    const IGraphNode* terminal_node = graph->GetNode(to);
-    if(!terminal_node) {
-        throw invalid_argument("'to' node not found in graph: " + to);
+template <class Cost>
+vector<uint32_t> AStar::SearchWith(const CsrGraph& graph, uint32_t from, uint32_t to, const Cost& step) const {
+    if (typeid(*heuristic) == typeid(ZeroDistance)) {
+        StaticHeuristic<ZeroDistance> zero;
+        return HasLowerBound() ? Search<Cost, StaticHeuristic<ZeroDistance>, true>(graph, from, to, step, zero)
+                               : Search<Cost, StaticHeuristic<ZeroDistance>, false>(graph, from, to, step, zero);
     }
+    if (typeid(*heuristic) == typeid(EuclideanDistance)) {
+        StaticHeuristic<EuclideanDistance> euclidean;
+        return HasLowerBound() ? Search<Cost, StaticHeuristic<EuclideanDistance>, true>(graph, from, to, step, euclidean)
+                               : Search<Cost, StaticHeuristic<EuclideanDistance>, false>(graph, from, to, step, euclidean);
+    }
+    VirtualHeuristic other{heuristic};
+    return HasLowerBound() ? Search<Cost, VirtualHeuristic, true>(graph, from, to, step, other)
+                           : Search<Cost, VirtualHeuristic, false>(graph, from, to, step, other);
+}
 
-    unordered_set<string> visited; // don't check nodes we've already visited
-    priority_queue<CandidatePath*, vector<CandidatePath*>,
-        function<bool(const CandidatePath*, const CandidatePath*)>>
-        possible_paths(compareCandidatePaths);
+template <class Cost, class Heuristic, bool Bounded>
+vector<uint32_t> AStar::Search(const CsrGraph& graph, uint32_t from, uint32_t to, const Cost& step, const Heuristic& guess) const {
+    const Float3 goal(graph.Position(to));
+    auto estimate = [&](uint32_t node) -> float {
+        const float h = guess(Float3(graph.Position(node)), goal);
+        return Bounded ? std::max(LowerBound(graph, node, to), h) : h;
+    };
 
+    SearchWorkspace::Lease search;
+    search->Reset(graph.NodeCount());
+    search->Reach(from, 0, SearchWorkspace::NoParent);
+    search->HeapPush(estimate(from), from);
 
-    // visited.insert(from);
-    possible_paths.push(
-        new CandidatePath(
-            new FStack<string>(from),
-            0
-        ));
+    uint64_t settled = 0;
+    while (!search->HeapEmpty()) {
+        const uint32_t node = search->HeapPop().second;
 
-    while (!possible_paths.empty()) {
-        CandidatePath* candidate = possible_paths.top();
-        possible_paths.pop();
+        if (search->Closed(node)) {
+            continue;
+        }
+        search->Close(node);
+        settled++;
 
-        // TODO
-        /*
-        if (candidate->path->ToList()->size() < 10) {
-            std::cerr << "Current Candidate: ";
-            for(string str : *(candidate->path->ToList())) {
-                std::cerr << " => " << str;
+        if (node == to) {
+            CountSettled(settled);
+            return search->Unwind(to);
+        }
+
+        const float distance = search->Distance(node);
+        for (uint32_t e = graph.EdgeBegin(node); e < graph.EdgeEnd(node); e++) {
+            const uint32_t next = graph.EdgeTarget(e);
+            if (search->Closed(next)) {
+                continue;
             }
-            std::cerr << std::endl;
-            std::cerr << "Length: " << candidate->distance << std::endl;
-            std::cerr << "Estimate: " << candidate->estimate << std::endl;
-        } else {
-            while(!possible_paths.empty()) {
-                std::cerr << "=============" << "REMAINING PATHS" << "==============" << std::endl;
-                CandidatePath* candidate = possible_paths.top();
-                possible_paths.pop();
-
-                std::cerr << "Other Candidate: ";
-                for(string str : *(candidate->path->ToList())) {
-                    std::cerr << " => " << str;
-                }
-                std::cerr << std::endl;
-                std::cerr << "Length: " << candidate->distance << std::endl;
-                std::cerr << "Estimate: " << candidate->estimate << std::endl;
+
+            const float tentative = distance + step(graph, e, node, next);
+            if (tentative < search->Distance(next)) {
+                search->Reach(next, tentative, node);
+                search->HeapPush(tentative + estimate(next), next);
             }
-            throw invalid_argument("END ME NOW");
         }
-        */
+    }
+    CountSettled(settled);
+    return {};
+}
 
-        const string path_end = candidate->path->Top();
-        // std::cerr << "at: " << path_end << std::endl;
-        if (visited.find(path_end) == visited.end()) {
-            visited.insert(path_end);
+vector<uint32_t> BreadthFirstSearch::GetIndexPath(const CsrGraph& graph, uint32_t from, uint32_t to) const {
+    checkIndex(graph, from, "from");
+    checkIndex(graph, to, "to");
+    if (from == to) {
+        return {from};
+    }
 
-            if(path_end == to) {
-                // we found our result
-                return *candidate->path->ToList();
-            } // implicit else
+    SearchWorkspace::Lease search;
+    search->Reset(graph.NodeCount());
+    vector<uint32_t>& possible_paths = search->Frontier();
 
+    search->Reach(from, 0, SearchWorkspace::NoParent);
+    possible_paths.push_back(from);
 
-            const IGraphNode* path_end_node = graph->GetNode(path_end);
-            if (!path_end_node) {
-                std::cerr << "Encountered node not in graph, named: ";
-                std::cerr << path_end << std::endl;
-                std::cerr << "Ignoring and continuing" << std::endl;
-                continue;
-            }
-
-            const vector<IGraphNode*>& next_steps = path_end_node->GetNeighbors();
+    for (size_t head = 0; head < possible_paths.size(); head++) {
+        const uint32_t node = possible_paths[head];
 
-            for(IGraphNode* next : next_steps) {
-                const string next_name = next->GetName();
+        for (uint32_t e = graph.EdgeBegin(node); e < graph.EdgeEnd(node); e++) {
+            const uint32_t next = graph.EdgeTarget(e);
+            if (next == to) {
+                vector<uint32_t> result = search->Unwind(node);
+                result.push_back(to);
+                return result;
+            }
 
-                possible_paths.push(
-                    new CandidatePath(
-                        candidate->path->Push(next->GetName()),
-                        candidate->distance + cost->Calculate(path_end_node->GetPosition(), next->GetPosition()),
-                        heuristic->Calculate(next->GetPosition(), terminal_node->GetPosition())
-                    ));
+            if (!search->Reached(next)) {
+                search->Reach(next, 0, node);
+                possible_paths.push_back(next);
             }
         }
     }
     return {};
 }
 
-std::vector<std::string> BreadthFirstSearch::GetPath(const IGraph* graph, const std::string& from, const std::string& to) const {
-    unordered_set<string> visited; // don't check nodes we've already visited
-    queue<CandidatePath*> possible_paths; // queue of all paths we're considering in BFS
+vector<uint32_t> DepthFirstSearch::GetIndexPath(const CsrGraph& graph, uint32_t from, uint32_t to) const {
+    checkIndex(graph, from, "from");
+    checkIndex(graph, to, "to");
+    if (from == to) {
+        return {from};
+    }
 
-    const IGraphNode* start_node = graph->GetNode(from);
-    // only here for debugging
-    if(!start_node) {
-        throw invalid_argument("'from' node not found in graph: " + from);
+    SearchWorkspace::Lease search;
+    search->Reset(graph.NodeCount());
+    vector<uint32_t>& possible_paths = search->Frontier();
+
+    search->Reach(from, 0, SearchWorkspace::NoParent);
+    possible_paths.push_back(from);
+
+    while (!possible_paths.empty()) {
+        const uint32_t node = possible_paths.back();
+        possible_paths.pop_back();
+
+        for (uint32_t e = graph.EdgeBegin(node); e < graph.EdgeEnd(node); e++) {
+            const uint32_t next = graph.EdgeTarget(e);
+            if (next == to) {
+                vector<uint32_t> result = search->Unwind(node);
+                result.push_back(to);
+                return result;
+            }
+
+            if (!search->Reached(next)) {
+                search->Reach(next, 0, node);
+                possible_paths.push_back(next);
+            }
+        }
     }
+    return {};
+}
 
-    const IGraphNode* terminal_node = graph->GetNode(to);
-    if(!terminal_node) {
-        throw invalid_argument("'to' node not found in graph: " + to);
+vector<string> AStar::GetPath(const IGraph* graph, const std::string& from, const std::string& to) const {
+    if (const CsrGraph* csr = dynamic_cast<const CsrGraph*>(graph)) {
+        return toNames(*csr, GetIndexPath(*csr, indexOrThrow(*csr, from, "from"), indexOrThrow(*csr, to, "to")));
     }
 
-    visited.insert(from);
-    possible_paths.push(
-        new CandidatePath(
-            new FStack<string>(from),
-            0
-        ));
+    const IGraphNode* start_node;
+    const IGraphNode* terminal_node;
+    checkNodes(graph, from, to, &start_node, &terminal_node);
+    const Float3 goal = terminal_node->GetPoint();
 
-    while(!possible_paths.empty()) {
-        auto* path = possible_paths.front();
-        possible_paths.pop();
+    unordered_map<const IGraphNode*, float> distance;
+    ParentMap parent;
+    unordered_set<const IGraphNode*> visited; // don't check nodes we've already visited
+
+    typedef pair<float, const IGraphNode*> Entry;
+    priority_queue<Entry, vector<Entry>, greater<Entry>> possible_paths;
+
+    // euclidean costs are the weights the graph was loaded with
+    const bool weighted = typeid(*cost) == typeid(EuclideanDistance);
 
-        const string path_end = path->path->Top();
-        // was checked to be in the graph when we added it
-        // so no need to check
+    distance[start_node] = 0;
+    parent[start_node] = NULL;
+    possible_paths.push(Entry(heuristic->Between(start_node->GetPoint(), goal), start_node));
+
+    while (!possible_paths.empty()) {
+        const IGraphNode* path_end_node = possible_paths.top().second;
+        possible_paths.pop();
 
-        const IGraphNode* path_end_node = graph->GetNode(path_end);
-        if (!path_end_node) {
-            std::cerr << "Encountered node not in graph, named: ";
-            std::cerr << path_end << std::endl;
-            std::cerr << "Ignoring and continuing" << std::endl;
+        if (!visited.insert(path_end_node).second) {
             continue;
         }
 
-        const vector<IGraphNode*> next_steps = path_end_node->GetNeighbors();
-        for(IGraphNode* next : next_steps) {
-            const string next_name = next->GetName();
-            if(next_name == to) {
+        if (path_end_node == terminal_node) {
+            // we found our result
+            CountSettled(visited.size());
+            return unwindNames(parent, terminal_node);
+        } // implicit else
+
+        const Float3 position = path_end_node->GetPoint();
+        for (const WeightedNeighbor& edge : path_end_node->WeightedNeighbors()) {
+            const IGraphNode* next = edge.node;
+            if (visited.count(next)) {
+                continue;
+            }
+
+            const Float3 next_position = next->GetPoint();
+            const float tentative = distance[path_end_node] + (weighted ? edge.weight : cost->Between(position, next_position));
+            auto known = distance.find(next);
+            if (known == distance.end() || tentative < known->second) {
+                distance[next] = tentative;
+                parent[next] = path_end_node;
+                possible_paths.push(Entry(tentative + heuristic->Between(next_position, goal), next));
+            }
+        }
+    }
+    CountSettled(visited.size());
+    return {};
+}
+
+std::vector<std::string> BreadthFirstSearch::GetPath(const IGraph* graph, const std::string& from, const std::string& to) const {
+    if (const CsrGraph* csr = dynamic_cast<const CsrGraph*>(graph)) {
+        return toNames(*csr, GetIndexPath(*csr, indexOrThrow(*csr, from, "from"), indexOrThrow(*csr, to, "to")));
+    }
+
+    const IGraphNode* start_node;
+    const IGraphNode* terminal_node;
+    checkNodes(graph, from, to, &start_node, &terminal_node);
+    if (start_node == terminal_node) {
+        return {from};
+    }
+
+    ParentMap parent; // doubles as the set of nodes we've already visited
+    queue<const IGraphNode*> possible_paths; // queue of all paths we're considering in BFS
+
+    parent[start_node] = NULL;
+    possible_paths.push(start_node);
+
+    while (!possible_paths.empty()) {
+        const IGraphNode* path_end_node = possible_paths.front();
+        possible_paths.pop();
+
+        for (const IGraphNode* next : path_end_node->GetNeighbors()) {
+            if (next == terminal_node) {
                 // we found our goal
-                vector<string> result = *path->path->ToList();
-                result.push_back(next_name);
-                // NOTE: This currently makes a large memory leak
-                // B/C None of the candidate paths, nor their FStack's are freed
-                // Not sure how to free the FStacks.
+                vector<string> result = unwindNames(parent, path_end_node);
+                result.push_back(next->GetName());
                 return result;
             } // implicit else
 
-
-            if(visited.find(next_name) == visited.end()) {
+            if (parent.insert({next, path_end_node}).second) {
                 // we haven't been to this node yet
-                visited.insert(next_name);
-                possible_paths.push(
-                    new CandidatePath(
-                        path->path->Push(next_name)));
+                possible_paths.push(next);
             }
         }
     }
@@ -219,67 +345,42 @@ std::vector<std::string> BreadthFirstSearch::GetPath(const IGraph* graph, const
 }
 
 std::vector<std::string> DepthFirstSearch::GetPath(const IGraph* graph, const std::string& from, const std::string& to) const {
-    unordered_set<string> visited; // don't check nodes we've already visited
-    vector<CandidatePath*> possible_paths; // stack of all paths we're considering in DFS
-
-    const IGraphNode* start_node = graph->GetNode(from);
-    // only here for debugging
-    if(!start_node) {
-        throw invalid_argument("'from' node not found in graph: " + from);
+    if (const CsrGraph* csr = dynamic_cast<const CsrGraph*>(graph)) {
+        return toNames(*csr, GetIndexPath(*csr, indexOrThrow(*csr, from, "from"), indexOrThrow(*csr, to, "to")));
     }
 
-    const IGraphNode* terminal_node = graph->GetNode(to);
-    if(!terminal_node) {
-        throw invalid_argument("'to' node not found in graph: " + to);
+    const IGraphNode* start_node;
+    const IGraphNode* terminal_node;
+    checkNodes(graph, from, to, &start_node, &terminal_node);
+    if (start_node == terminal_node) {
+        return {from};
     }
 
-    visited.insert(from);
-    possible_paths.push_back(
-        new CandidatePath(
-            new FStack<string>(from),
-            0
-        ));
-
-    while(!possible_paths.empty()) {
-        auto* path = possible_paths.back();
-        possible_paths.pop_back();
+    ParentMap parent; // doubles as the set of nodes we've already visited
+    vector<const IGraphNode*> possible_paths; // stack of all paths we're considering in DFS
 
-        const string path_end = path->path->Top();
-        // was checked to be in the graph when we added it
-        // so no need to check
+    parent[start_node] = NULL;
+    possible_paths.push_back(start_node);
 
-        const IGraphNode* path_end_node = graph->GetNode(path_end);
-        if (!path_end_node) {
-            std::cerr << "Encountered node not in graph, named: ";
-            std::cerr << path_end << std::endl;
-            std::cerr << "Ignoring and continuing" << std::endl;
-            continue;
-        }
+    while (!possible_paths.empty()) {
+        const IGraphNode* path_end_node = possible_paths.back();
+        possible_paths.pop_back();
 
-        const vector<IGraphNode*> next_steps = path_end_node->GetNeighbors();
-        for(IGraphNode* next : next_steps) {
-            const string next_name = next->GetName();
-            if(next_name == to) {
+        for (const IGraphNode* next : path_end_node->GetNeighbors()) {
+            if (next == terminal_node) {
                 // we found our goal
-                vector<string> result = *path->path->ToList();
-                result.push_back(next_name);
-                // NOTE: This currently makes a large memory leak
-                // B/C None of the candidate paths, nor their FStack's are freed
-                // Not sure how to free the FStacks.
+                vector<string> result = unwindNames(parent, path_end_node);
+                result.push_back(next->GetName());
                 return result;
             } // implicit else
 
-
-            if(visited.find(next_name) == visited.end()) {
+            if (parent.insert({next, path_end_node}).second) {
                 // we haven't been to this node yet
-                visited.insert(next_name);
-                possible_paths.push_back(
-                    new CandidatePath(
-                        path->path->Push(next_name)));
+                possible_paths.push_back(next);
             }
         }
     }
     return {};
 }
 
-}
\ No newline at end of file
+}
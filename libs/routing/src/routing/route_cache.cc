@@ -0,0 +1,139 @@
+#include "routing/route_cache.h"
+
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+namespace routing {
+
+static const char* const fileMagic = "routecache";
+static const int fileVersion = 3;
+
+RouteCache::RouteCache(size_t capacity) : capacity(capacity), hits(0), misses(0) {
+}
+
+size_t RouteCache::KeyHash::operator()(const Key& key) const {
+    uint64_t hash = key.from * 0x9e3779b97f4a7c15ull;
+    hash = (hash ^ (hash >> 29) ^ key.to) * 0xbf58476d1ce4e5b9ull;
+    return static_cast<size_t>(hash ^ (hash >> 32) ^ key.strategy);
+}
+
+uint32_t RouteCache::StrategyIndex(const std::string& strategy) {
+    for (uint32_t i = 0; i < strategies.size(); i++) {
+        if (strategies[i] == strategy) {
+            return i;
+        }
+    }
+    strategies.push_back(strategy);
+    return static_cast<uint32_t>(strategies.size() - 1);
+}
+
+std::shared_ptr<const RouteCache::Path> RouteCache::Find(const std::string& strategy, uint64_t from, uint64_t to) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto found = index.find(Key{StrategyIndex(strategy), from, to});
+    if (found == index.end()) {
+        misses++;
+        return NULL;
+    }
+    hits++;
+    entries.splice(entries.begin(), entries, found->second);
+    return found->second->path;
+}
+
+void RouteCache::Insert(const std::string& strategy, uint64_t from, uint64_t to, std::shared_ptr<const Path> path) {
+    if (capacity == 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    const Key key{StrategyIndex(strategy), from, to};
+    auto found = index.find(key);
+    if (found != index.end()) {
+        found->second->path = path;
+        entries.splice(entries.begin(), entries, found->second);
+        return;
+    }
+    if (entries.size() >= capacity) {
+        index.erase(entries.back().key);
+        entries.pop_back();
+    }
+    entries.push_front(Entry{key, path});
+    index[key] = entries.begin();
+}
+
+void RouteCache::Clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+    index.clear();
+}
+
+size_t RouteCache::Size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size();
+}
+
+// After a header with the graph's fingerprint, one route per line: strategy,
+// from, to, point count and the coordinates.  The least recently used route
+// comes first, so loading keeps the order.
+void RouteCache::Save(const std::string& file, uint64_t graph) const {
+    std::ofstream out(file.c_str());
+    if (!out) {
+        throw std::runtime_error("Cannot write route cache " + file);
+    }
+    out.precision(std::numeric_limits<float>::max_digits10);
+    out << fileMagic << " " << fileVersion << " " << graph << "\n";
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto entry = entries.rbegin(); entry != entries.rend(); ++entry) {
+        out << strategies[entry->key.strategy] << " " << entry->key.from << " " << entry->key.to << " " << entry->path->size();
+        for (const std::vector<float>& point : *entry->path) {
+            out << " " << point.size();
+            for (float value : point) {
+                out << " " << value;
+            }
+        }
+        out << "\n";
+    }
+    if (!out) {
+        throw std::runtime_error("Cannot write route cache " + file);
+    }
+}
+
+void RouteCache::Load(const std::string& file, uint64_t graph) {
+    std::ifstream in(file.c_str());
+    std::string magic;
+    int version = 0;
+    uint64_t fingerprint = 0;
+    if (!(in >> magic >> version >> fingerprint) || magic != fileMagic || version != fileVersion) {
+        throw std::runtime_error("Not a route cache: " + file);
+    }
+    if (fingerprint != graph) {
+        throw std::runtime_error("Route cache for another graph: " + file);
+    }
+
+    std::string strategy;
+    uint64_t from, to;
+    size_t points;
+    while (in >> strategy >> from >> to >> points) {
+        std::shared_ptr<Path> path(new Path());
+        for (size_t i = 0; i < points && in; i++) {
+            size_t size;
+            if (!(in >> size) || size > 3) {
+                throw std::runtime_error("Corrupt route cache: " + file);
+            }
+            std::vector<float> point(size);
+            for (float& value : point) {
+                in >> value;
+            }
+            path->push_back(point);
+        }
+        if (!in) {
+            throw std::runtime_error("Corrupt route cache: " + file);
+        }
+        Insert(strategy, from, to, path);
+    }
+    if (!in.eof()) {
+        throw std::runtime_error("Corrupt route cache: " + file);
+    }
+}
+
+}
@@ -0,0 +1,73 @@
+#include "routing/search_workspace.h"
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+
+namespace routing {
+
+void SearchWorkspace::Reset(uint32_t nodeCount) {
+    if (reached.size() < nodeCount) {
+        reached.resize(nodeCount, 0);
+        closed.resize(nodeCount, 0);
+        distance.resize(nodeCount);
+        parent.resize(nodeCount);
+    }
+
+    generation++;
+    if (generation == 0) {
+        // stamps wrapped around, old marks could alias the new generation
+        std::fill(reached.begin(), reached.end(), 0);
+        std::fill(closed.begin(), closed.end(), 0);
+        generation = 1;
+    }
+
+    heap.clear();
+    frontier.clear();
+}
+
+void SearchWorkspace::HeapPush(float key, uint32_t node) {
+    heap.push_back(HeapEntry(key, node));
+    std::push_heap(heap.begin(), heap.end(), std::greater<HeapEntry>());
+}
+
+SearchWorkspace::HeapEntry SearchWorkspace::HeapPop() {
+    std::pop_heap(heap.begin(), heap.end(), std::greater<HeapEntry>());
+    HeapEntry top = heap.back();
+    heap.pop_back();
+    return top;
+}
+
+std::vector<uint32_t> SearchWorkspace::Unwind(uint32_t last) const {
+    size_t length = 0;
+    for (uint32_t node = last; node != NoParent; node = parent[node]) {
+        length++;
+    }
+
+    std::vector<uint32_t> path(length);
+    for (uint32_t node = last; node != NoParent; node = parent[node]) {
+        path[--length] = node;
+    }
+    return path;
+}
+
+SearchWorkspace::Lease::Lease() : workspace(NULL) {
+    static thread_local std::vector<std::unique_ptr<SearchWorkspace>> pool;
+    for (auto& candidate : pool) {
+        if (!candidate->inUse) {
+            workspace = candidate.get();
+            break;
+        }
+    }
+    if (!workspace) {
+        pool.emplace_back(new SearchWorkspace());
+        workspace = pool.back().get();
+    }
+    workspace->inUse = true;
+}
+
+SearchWorkspace::Lease::~Lease() {
+    workspace->inUse = false;
+}
+
+}
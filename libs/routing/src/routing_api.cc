@@ -1,11 +1,16 @@
 #include "routing_api.h"
 #include "parsers/osm/osm_graph_factory.h"
 #include "parsers/obj/obj_graph_factory.h"
+#include "parsers/snapshot/snapshot_graph_factory.h"
+#include "impl/csr_graph.h"
+
+#include <stdexcept>
 
 namespace routing {
 
-RoutingAPI::RoutingAPI() {
-    factories.push_back(new OSMGraphFactory());
+RoutingAPI::RoutingAPI(unsigned importThreads) {
+    factories.push_back(new SnapshotGraphFactory());
+    factories.push_back(new OSMGraphFactory(importThreads));
     factories.push_back(new ObjGraphFactory());
 }
 
@@ -19,13 +24,54 @@ IGraph* RoutingAPI::LoadFromFile(const std::string& file) const {
     for (int i = 0; i < factories.size(); i++) {
         IGraph* graph = factories[i]->Create(file);
         if (graph) {
-            return graph;
+            if (dynamic_cast<CsrGraph*>(graph)) {
+                return graph;
+            }
+
+            // searches run on the compact integer form of the parsed graph
+            IGraph* csr = new CsrGraph(*graph);
+            delete graph;
+            return csr;
         }
     }
 
     return NULL;
 }
 
+void RoutingAPI::SaveSnapshot(const IGraph* graph, const std::string& file, const std::string& source) const {
+    const CsrGraph* csr = dynamic_cast<const CsrGraph*>(graph);
+    if (csr) {
+        csr->WriteSnapshot(file, source);
+        return;
+    }
+
+    CsrGraph converted(*graph);
+    converted.WriteSnapshot(file, source);
+}
+
+IGraph* RoutingAPI::LoadWithSnapshot(const std::string& file) const {
+    std::string snapshot = file.substr(0, file.find_last_of('.')) + ".rgs";
+    if (snapshot != file) {
+        try {
+            return CsrGraph::MapSnapshot(snapshot, file);
+        }
+        catch (const std::exception&) {
+            // missing, from another version or older than the map, rebuilt below
+        }
+    }
+
+    IGraph* graph = LoadFromFile(file);
+    if (graph && snapshot != file) {
+        try {
+            SaveSnapshot(graph, snapshot, file);
+        }
+        catch (const std::exception&) {
+            // read-only data directory or names that cannot be snapshotted
+        }
+    }
+    return graph;
+}
+
 void RoutingAPI::AddFactory(const IGraphFactory* factory) {
     factories.push_back(factory);
 }
@@ -0,0 +1,17 @@
+#include "routing_strategy.h"
+#include "impl/csr_graph.h"
+
+namespace routing {
+
+std::vector<uint32_t> RoutingStrategy::GetIndexPath(const CsrGraph& graph, uint32_t from, uint32_t to) const {
+    std::vector<std::string> names = GetPath(&graph, graph.NameOf(from), graph.NameOf(to));
+
+    std::vector<uint32_t> path;
+    path.reserve(names.size());
+    for (const std::string& name : names) {
+        path.push_back(graph.IndexOf(name));
+    }
+    return path;
+}
+
+}
@@ -0,0 +1,170 @@
+#include "spatial_index.h"
+
+#include <algorithm>
+
+namespace routing {
+
+SpatialIndex::SpatialIndex(const float* positions, uint32_t count) : ids(count), axes(count, 0) {
+    for (uint32_t i = 0; i < count; i++) {
+        ids[i] = i;
+    }
+
+    // build on the id permutation, reading coordinates from the source
+    coords.assign(positions, positions + 3 * count);
+    Build(0, count);
+
+    std::vector<float> ordered(3 * count);
+    for (uint32_t slot = 0; slot < count; slot++) {
+        for (int j = 0; j < 3; j++) {
+            ordered[3 * slot + j] = positions[3 * ids[slot] + j];
+        }
+    }
+    coords.swap(ordered);
+}
+
+void SpatialIndex::Build(uint32_t lo, uint32_t hi) {
+    if (hi - lo <= 1) {
+        return;
+    }
+
+    // split along the widest dimension of the range
+    float min[3], max[3];
+    for (int j = 0; j < 3; j++) {
+        min[j] = max[j] = coords[3 * ids[lo] + j];
+    }
+    for (uint32_t slot = lo + 1; slot < hi; slot++) {
+        for (int j = 0; j < 3; j++) {
+            float value = coords[3 * ids[slot] + j];
+            min[j] = std::min(min[j], value);
+            max[j] = std::max(max[j], value);
+        }
+    }
+    uint8_t axis = 0;
+    for (uint8_t j = 1; j < 3; j++) {
+        if (max[j] - min[j] > max[axis] - min[axis]) {
+            axis = j;
+        }
+    }
+
+    const uint32_t mid = lo + (hi - lo) / 2;
+    std::nth_element(ids.begin() + lo, ids.begin() + mid, ids.begin() + hi,
+        [this, axis](uint32_t a, uint32_t b) { return coords[3 * a + axis] < coords[3 * b + axis]; });
+    axes[mid] = axis;
+
+    Build(lo, mid);
+    Build(mid + 1, hi);
+}
+
+float SpatialIndex::DistanceSquared(uint32_t slot, const float point[3]) const {
+    float dx = coords[3 * slot] - point[0];
+    float dy = coords[3 * slot + 1] - point[1];
+    float dz = coords[3 * slot + 2] - point[2];
+    return dx*dx + dy*dy + dz*dz;
+}
+
+void SpatialIndex::Search(uint32_t lo, uint32_t hi, const float point[3], uint32_t k, std::vector<Candidate>& best) const {
+    if (lo >= hi) {
+        return;
+    }
+
+    const uint32_t mid = lo + (hi - lo) / 2;
+    Candidate candidate = {DistanceSquared(mid, point), ids[mid]};
+    if (best.size() < k) {
+        best.push_back(candidate);
+        std::push_heap(best.begin(), best.end());
+    } else if (candidate < best.front()) {
+        std::pop_heap(best.begin(), best.end());
+        best.back() = candidate;
+        std::push_heap(best.begin(), best.end());
+    }
+
+    if (hi - lo == 1) {
+        return;
+    }
+
+    const uint8_t axis = axes[mid];
+    const float diff = point[axis] - coords[3 * mid + axis];
+    if (diff < 0) {
+        Search(lo, mid, point, k, best);
+        if (best.size() < k || diff * diff <= best.front().distance) {
+            Search(mid + 1, hi, point, k, best);
+        }
+    } else {
+        Search(mid + 1, hi, point, k, best);
+        if (best.size() < k || diff * diff <= best.front().distance) {
+            Search(lo, mid, point, k, best);
+        }
+    }
+}
+
+void SpatialIndex::Collect(uint32_t lo, uint32_t hi, const float point[3], float radius2, std::vector<Candidate>& found) const {
+    if (lo >= hi) {
+        return;
+    }
+
+    const uint32_t mid = lo + (hi - lo) / 2;
+    float distance = DistanceSquared(mid, point);
+    if (distance <= radius2) {
+        Candidate candidate = {distance, ids[mid]};
+        found.push_back(candidate);
+    }
+
+    const uint8_t axis = axes[mid];
+    const float diff = point[axis] - coords[3 * mid + axis];
+    if (diff <= 0 || diff * diff <= radius2) {
+        Collect(lo, mid, point, radius2, found);
+    }
+    if (diff >= 0 || diff * diff <= radius2) {
+        Collect(mid + 1, hi, point, radius2, found);
+    }
+}
+
+uint32_t SpatialIndex::Nearest(const float point[3]) const {
+    std::vector<Candidate> best;
+    best.reserve(1);
+    Search(0, Size(), point, 1, best);
+    return best.empty() ? NotFound : best.front().id;
+}
+
+std::vector<uint32_t> SpatialIndex::Nearest(const std::vector<float>& points) const {
+    std::vector<uint32_t> result(points.size() / 3);
+    std::vector<Candidate> best;
+    best.reserve(1);
+    for (size_t i = 0; i < result.size(); i++) {
+        best.clear();
+        Search(0, Size(), &points[3 * i], 1, best);
+        result[i] = best.empty() ? NotFound : best.front().id;
+    }
+    return result;
+}
+
+std::vector<uint32_t> SpatialIndex::KNearest(const float point[3], uint32_t k) const {
+    std::vector<Candidate> best;
+    best.reserve(k);
+    if (k > 0) {
+        Search(0, Size(), point, k, best);
+    }
+    std::sort_heap(best.begin(), best.end());
+
+    std::vector<uint32_t> result;
+    result.reserve(best.size());
+    for (const Candidate& candidate : best) {
+        result.push_back(candidate.id);
+    }
+    return result;
+}
+
+std::vector<uint32_t> SpatialIndex::Within(const float point[3], float radius) const {
+    std::vector<Candidate> found;
+    Collect(0, Size(), point, radius * radius, found);
+    std::sort(found.begin(), found.end());
+
+    std::vector<uint32_t> result;
+    result.reserve(found.size());
+    for (const Candidate& candidate : found) {
+        result.push_back(candidate.id);
+    }
+    return result;
+}
+
+}
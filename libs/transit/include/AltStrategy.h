@@ -0,0 +1,29 @@
+#ifndef ALT_STRATEGY_H_
+#define ALT_STRATEGY_H_
+
+#include "PathStrategy.h"
+#include "graph.h"
+#include "routing_strategy.h"
+
+/**
+ * @brief this class inhertis from the PathStrategy class and is responsible for
+ * generating the landmark guided astar (ALT) path that the drone will take.
+ */
+class AltStrategy : public PathStrategy {
+ public:
+  /**
+   * @brief Construct a new ALT Strategy object
+   *
+   * @param position Current position
+   * @param destination End destination
+   * @param graph Graph/Nodes of the map
+   * @param alt Landmark guided A* prepared for graph, or nullptr to fall
+   * back to A*
+   * @param planner Planner computing the path in the background, or nullptr
+   * to compute it in the constructor
+   */
+  AltStrategy(Vector3 position, Vector3 destination,
+              const routing::IGraph* graph, const routing::RoutingStrategy* alt,
+              PathPlanner* planner = nullptr);
+};
+#endif  // ALT_STRATEGY_H_
@@ -16,8 +16,11 @@ class AstarStrategy : public PathStrategy {
    * @param position Current position
    * @param destination End destination
    * @param graph Graph/Nodes of the map
+   * @param planner Planner computing the path in the background, or nullptr
+   * to compute it in the constructor
    */
   AstarStrategy(Vector3 position, Vector3 destination,
-                const routing::IGraph* graph);
+                const routing::IGraph* graph,
+                PathPlanner* planner = nullptr);
 };
 #endif  // ASTAR_STRATEGY_H_
@@ -198,6 +198,28 @@ class BatteryDecorator : public IEntity {
    */
   virtual void rotate(double angle) { decoratedDrone->rotate(angle); }
 
+  /**
+   * @brief Attach the decorated drone, which holds the state, to the store.
+   *
+   * @param store The store holding the entity.
+   * @param slot The entity's slot in the store.
+   * @param id The id assigned by the store.
+   */
+  virtual void attach(EntityStore* store, uint32_t slot, int id) {
+    decoratedDrone->attach(store, slot, id);
+  }
+
+  /**
+   * @brief Detach the decorated drone from the store.
+   *
+   * @param position The drone's last position.
+   * @param direction The drone's last direction.
+   * @param speed The drone's speed.
+   */
+  virtual void detach(Vector3 position, Vector3 direction, double speed) {
+    decoratedDrone->detach(position, direction, speed);
+  }
+
  private:
   Drone* decoratedDrone;
   double batteryLevel;
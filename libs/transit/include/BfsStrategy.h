@@ -16,8 +16,11 @@ class BfsStrategy : public PathStrategy {
    * @param position The current starting position.
    * @param destination The end destination for the pathfinding.
    * @param graph The graph representing the nodes and connections in the map.
+   * @param planner Planner computing the path in the background, or nullptr
+   * to compute it in the constructor
    */
   BfsStrategy(Vector3 position, Vector3 destination,
-              const routing::IGraph* graph);
+              const routing::IGraph* graph,
+              PathPlanner* planner = nullptr);
 };
 #endif  // BFS_STRATEGY_H_
@@ -0,0 +1,26 @@
+#ifndef BIDIRECTIONAL_ASTAR_STRATEGY_H_
+#define BIDIRECTIONAL_ASTAR_STRATEGY_H_
+
+#include "PathStrategy.h"
+#include "graph.h"
+
+/**
+ * @brief this class inhertis from the PathStrategy class and is responsible for
+ * generating the bidirectional astar path that the drone will take.
+ */
+class BidirectionalAstarStrategy : public PathStrategy {
+ public:
+  /**
+   * @brief Construct a new Bidirectional Astar Strategy object
+   *
+   * @param position Current position
+   * @param destination End destination
+   * @param graph Graph/Nodes of the map
+   * @param planner Planner computing the path in the background, or nullptr
+   * to compute it in the constructor
+   */
+  BidirectionalAstarStrategy(Vector3 position, Vector3 destination,
+                             const routing::IGraph* graph,
+                             PathPlanner* planner = nullptr);
+};
+#endif  // BIDIRECTIONAL_ASTAR_STRATEGY_H_
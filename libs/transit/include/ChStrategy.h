@@ -0,0 +1,30 @@
+#ifndef CH_STRATEGY_H_
+#define CH_STRATEGY_H_
+
+#include "PathStrategy.h"
+#include "graph.h"
+#include "routing_strategy.h"
+
+/**
+ * @brief this class inhertis from the PathStrategy class and is responsible for
+ * generating the contraction hierarchy path that the drone will take.
+ */
+class ChStrategy : public PathStrategy {
+ public:
+  /**
+   * @brief Construct a new Contraction Hierarchy Strategy object
+   *
+   * @param position Current position
+   * @param destination End destination
+   * @param graph Graph/Nodes of the map
+   * @param hierarchy Contraction hierarchy prepared for graph, or nullptr to
+   * fall back to Dijkstra
+   * @param planner Planner computing the path in the background, or nullptr
+   * to compute it in the constructor
+   */
+  ChStrategy(Vector3 position, Vector3 destination,
+             const routing::IGraph* graph,
+             const routing::RoutingStrategy* hierarchy,
+             PathPlanner* planner = nullptr);
+};
+#endif  // CH_STRATEGY_H_
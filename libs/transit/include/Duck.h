@@ -1,8 +1,6 @@
 #ifndef Duck_H
 #define Duck_H
 
-#include <cstdlib>
-#include <ctime>
 #include <vector>
 
 #include "AstarStrategy.h"
@@ -35,6 +33,8 @@ class Duck : public IEntity {
   void update(double dt);
 
  private:
+  Vector3 randomDestination();
+
   IStrategy* toFinalDestination = nullptr;
   Vector3 start;
   Vector3 dest;
@@ -0,0 +1,117 @@
+#ifndef ENTITY_STORE_H_
+#define ENTITY_STORE_H_
+
+#include <cstdint>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+
+#include "math/vector3.h"
+
+class IEntity;
+
+/**
+ * @brief Dense storage for the entities of a simulation.
+ *
+ * Entities are grouped by concrete type, and each group keeps the entity
+ * pointers and their positions, directions and speeds in parallel arrays,
+ * so a pass over the simulation walks contiguous memory one kind at a time.
+ * Entity ids are slot map handles: a slot index plus the slot's generation,
+ * which stays valid while entities are removed and the dense arrays are
+ * compacted, and never matches an entity that was removed before.
+ *
+ * IEntity remains the interface to an entity; once inserted its getters and
+ * setters read and write the arrays here.
+ */
+class EntityStore {
+ public:
+  /**
+   * @brief The entities of one concrete type, index i of every array
+   * belonging to the same entity.
+   */
+  struct Kind {
+    std::vector<IEntity*> entities;
+    std::vector<Vector3> positions;
+    std::vector<Vector3> directions;
+    std::vector<double> speeds;
+    std::vector<uint32_t> slots;
+  };
+
+  /**
+   * @brief Adds an entity and moves its position, direction and speed into
+   * the store. The store does not take ownership.
+   * @param entity The entity to add
+   * @return The id assigned to the entity
+   */
+  int insert(IEntity* entity);
+
+  /**
+   * @brief Removes an entity, keeping the arrays of its kind dense.
+   * @param id Id of the entity
+   * @return The removed entity, or nullptr if no entity has this id
+   */
+  IEntity* remove(int id);
+
+  /**
+   * @brief Looks up an entity by id.
+   * @param id Id of the entity
+   * @return The entity, or nullptr if no entity has this id
+   */
+  IEntity* get(int id) const;
+
+  /**
+   * @brief Number of entities in the store
+   */
+  int size() const { return count; }
+
+  /**
+   * @brief The entity groups, for passes that work on the arrays directly
+   */
+  const std::vector<Kind>& getKinds() const { return kinds; }
+
+  /**
+   * @brief Calls f on every entity, one kind after the other. f must not
+   * insert or remove entities.
+   * @param f Callable taking an IEntity*
+   */
+  template <typename F>
+  void forEach(F f) const {
+    for (const Kind& kind : kinds) {
+      for (size_t i = 0; i < kind.entities.size(); i++) {
+        f(kind.entities[i]);
+      }
+    }
+  }
+
+  /// @brief Kinematic state of the entity in a slot, used by IEntity
+  Vector3 getPosition(uint32_t slot) const { return at(slot).positions[slots[slot].index]; }
+  Vector3 getDirection(uint32_t slot) const { return at(slot).directions[slots[slot].index]; }
+  double getSpeed(uint32_t slot) const { return at(slot).speeds[slots[slot].index]; }
+  void setPosition(uint32_t slot, const Vector3& position) { at(slot).positions[slots[slot].index] = position; }
+  void setDirection(uint32_t slot, const Vector3& direction) { at(slot).directions[slots[slot].index] = direction; }
+
+ private:
+  /// Low bits of an id select the slot, the rest hold its generation.
+  static const int slotBits = 20;
+  static const uint32_t slotMask = (1u << slotBits) - 1;
+  static const uint32_t generationMask = (1u << (31 - slotBits)) - 1;
+
+  struct Slot {
+    uint32_t kind;
+    uint32_t index;
+    uint32_t generation;
+    bool used;
+  };
+
+  const Kind& at(uint32_t slot) const { return kinds[slots[slot].kind]; }
+  Kind& at(uint32_t slot) { return kinds[slots[slot].kind]; }
+  bool find(int id, uint32_t* slot) const;
+
+  std::vector<Slot> slots;
+  std::vector<uint32_t> freeSlots;
+  std::vector<Kind> kinds;
+  std::unordered_map<std::type_index, uint32_t> kindOf;
+  int count = 0;
+};
+
+#endif  // ENTITY_STORE_H_
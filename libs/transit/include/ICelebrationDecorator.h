@@ -31,8 +31,9 @@ class ICelebrationDecorator : public IStrategy {
    *
    * @param entity Entity to move
    * @param dt Delta Time
+   * @return Time left over after the celebration ended
    */
-  virtual void move(IEntity* entity, double dt);
+  virtual double move(IEntity* entity, double dt);
 
   /**
    * @brief Check if the movement is completed by checking the time.
@@ -42,7 +43,8 @@ class ICelebrationDecorator : public IStrategy {
   virtual bool isCompleted();
 
   /**
-   * @brief Abstract method to define celebration behavior.
+   * @brief Abstract method to define celebration behavior. dt is never more
+   * than the celebration time left, but may span many frames.
    *
    * @param entity Entity that is celebrating.
    * @param dt Delta time for the celebration update.
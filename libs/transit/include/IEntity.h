@@ -1,12 +1,14 @@
 #ifndef ENTITY_H_
 #define ENTITY_H_
 
+#include <random>
 #include <vector>
 
 #include "graph.h"
 #include "math/vector3.h"
 #include "util/json.h"
 
+class EntityStore;
 class SimulationModel;
 
 /**
@@ -17,6 +19,9 @@ class SimulationModel;
  * and details. It also has a speed, which determines how fast the entity moves
  * in the physical system. Subclasses of IEntity can override the `Update`
  * function to implement their own movement behavior.
+ *
+ * Once the entity is added to an EntityStore its position, direction and speed
+ * live in the store's arrays; the accessors below work the same either way.
  */
 class IEntity {
  public:
@@ -43,6 +48,12 @@ class IEntity {
    */
   virtual void linkModel(SimulationModel* model);
 
+  /**
+   * @brief Gets the simulation model the entity is linked to.
+   * @return The model, or nullptr if the entity is not linked yet.
+   */
+  virtual SimulationModel* getModel() const;
+
   /**
    * @brief Gets the ID of the entity.
    * @return The ID of the entity.
@@ -115,15 +126,41 @@ class IEntity {
    */
   virtual void update(double dt) = 0;
 
+  /**
+   * @brief Called by EntityStore when the entity is inserted. From now on
+   * the entity's kinematic state is kept in the store.
+   * @param store The store holding the entity
+   * @param slot The entity's slot in the store
+   * @param id The id the store assigned to the entity
+   */
+  virtual void attach(EntityStore* store, uint32_t slot, int id);
+
+  /**
+   * @brief Called by EntityStore when the entity is removed, handing back
+   * its kinematic state.
+   * @param position The entity's last position
+   * @param direction The entity's last direction
+   * @param speed The entity's speed
+   */
+  virtual void detach(Vector3 position, Vector3 direction, double speed);
+
  protected:
   SimulationModel* model = nullptr;
   int id = -1;
+  // the entity's own random numbers, seeded with its id so that a run does
+  // not depend on which thread updates the entity
+  std::mt19937 generator;
   JsonObject details;
-  Vector3 position;
-  Vector3 direction;
   std::string color;
   std::string name;
+
+ private:
+  // only used while the entity is not in a store
+  Vector3 position;
+  Vector3 direction;
   double speed = 0;
+  EntityStore* store = nullptr;
+  uint32_t slot = 0;
 };
 
 #endif
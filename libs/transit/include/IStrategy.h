@@ -10,12 +10,20 @@
 class IStrategy {
  public:
   /**
-   * @brief Move toward next position
+   * @brief Virtual destructor, as strategies are deleted through IStrategy
+   */
+  virtual ~IStrategy() {}
+
+  /**
+   * @brief Move toward next position. A single call may cover any amount of
+   * time; strategies advance through as much of their work as dt allows.
    *
    * @param entity Entity to move
    * @param dt Delta Time
+   * @return The part of dt left over after the strategy completed, 0 while it
+   * is still running
    */
-  virtual void move(IEntity* entity, double dt) = 0;
+  virtual double move(IEntity* entity, double dt) = 0;
 
   /**
    * @brief Check if the trip is completed
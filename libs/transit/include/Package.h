@@ -76,26 +76,11 @@ class Package : public IEntity {
    */
   std::string getName();
 
-  /**
-   * @brief Get the current position of the package.
-   *
-   * @return Vector3 representing the current position of the package.
-   */
-  Vector3 getPosition() const;
-
-  /**
-   * @brief Set the position of the package.
-   *
-   * @param pos_ Vector3 representing the new position of the package.
-   */
-  void setPosition(Vector3 pos_);
-
  private:
   Vector3 destination;
   std::string strategyName;
   Robot* owner = nullptr;
   std::string name;
-  Vector3 position;
 };
 
 #endif  // PACKAGE_H
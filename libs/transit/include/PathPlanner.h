@@ -0,0 +1,71 @@
+#ifndef PATH_PLANNER_H_
+#define PATH_PLANNER_H_
+
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "graph.h"
+#include "routing_strategy.h"
+
+/**
+ * @brief Computes routes on background threads.
+ *
+ * Route requests are queued and answered in order by a fixed set of worker
+ * threads, so a long search never holds up the simulation tick that asked
+ * for it. The graph and routing strategy of a request must outlive the
+ * planner, which finishes every queued request before it is destroyed.
+ */
+class PathPlanner {
+ public:
+  /**
+   * @brief A route as a list of points
+   */
+  typedef std::vector<std::vector<float>> Path;
+
+  /**
+   * @brief Starts the worker threads
+   * @param threads Number of worker threads, at least 1
+   */
+  explicit PathPlanner(int threads);
+
+  /**
+   * @brief Answers the queued requests and joins the worker threads
+   */
+  ~PathPlanner();
+
+  /**
+   * @brief Number of worker threads
+   */
+  int getThreadCount() const { return workers.size(); }
+
+  /**
+   * @brief Queues a route request
+   * @param start Start of the route
+   * @param end End of the route
+   * @param graph Graph to route on
+   * @param strategy Search used on the graph
+   * @return The route, once a worker has computed it
+   */
+  std::shared_future<Path> plan(std::vector<float> start,
+                                std::vector<float> end,
+                                const routing::IGraph* graph,
+                                const routing::RoutingStrategy& strategy);
+
+  PathPlanner(const PathPlanner& planner) = delete;
+  PathPlanner& operator=(const PathPlanner& planner) = delete;
+
+ private:
+  void workerLoop();
+
+  std::vector<std::thread> workers;
+  std::mutex mutex;
+  std::condition_variable wake;
+  std::deque<std::packaged_task<Path()>> requests;
+  bool stopping = false;
+};
+
+#endif  // PATH_PLANNER_H_
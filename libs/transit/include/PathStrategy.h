@@ -1,16 +1,45 @@
 #ifndef PATH_STRATEGY_H_
 #define PATH_STRATEGY_H_
 
+#include <future>
+
 #include "IStrategy.h"
+#include "PathPlanner.h"
+#include "graph.h"
+#include "routing_strategy.h"
 
 /**
  * @brief this class inhertis from the IStrategy class and is represents
- * a movement strategy where the entity simply moves along the given path
+ * a movement strategy where the entity simply moves along the given path.
+ * The path may still be computed by a PathPlanner, in which case the entity
+ * stays where it is until the path arrives.
  */
 class PathStrategy : public IStrategy {
  protected:
   std::vector<std::vector<float>> path;
   int index;
+  // the path while a planner is still computing it
+  std::shared_future<PathPlanner::Path> pending;
+  // how the path was planned, to plan it again once the weights change; the
+  // model keeps the graph and its searches for as long as it has entities
+  Vector3 destination;
+  const routing::IGraph* graph = nullptr;
+  const routing::RoutingStrategy* strategy = nullptr;
+  uint64_t metricVersion = 0;
+
+  /**
+   * @brief Computes the path between two points, in the background if a
+   * planner is given
+   *
+   * @param position Start of the path
+   * @param destination End of the path
+   * @param graph Graph to route on
+   * @param strategy Search used on the graph
+   * @param planner Planner to queue the search with, or nullptr to search now
+   */
+  void plan(Vector3 position, Vector3 destination,
+            const routing::IGraph* graph,
+            const routing::RoutingStrategy& strategy, PathPlanner* planner);
 
  public:
   /**
@@ -21,12 +50,16 @@ class PathStrategy : public IStrategy {
   PathStrategy(std::vector<std::vector<float>> path = {});
 
   /**
-   * @brief Move toward next position in the path
+   * @brief Move along the path, passing as many points as dt allows. If the
+   * entity's model replans routes and the weights the path was planned with
+   * have changed, the rest of the path is planned again from where the
+   * entity is first.
    *
    * @param entity Entity to move
    * @param dt Delta Time
+   * @return Time left over after reaching the end of the path
    */
-  virtual void move(IEntity* entity, double dt);
+  virtual double move(IEntity* entity, double dt);
 
   /**
    * @brief Check if the trip is completed by seeing if index
@@ -36,6 +69,18 @@ class PathStrategy : public IStrategy {
    */
   virtual bool isCompleted();
 
+  /**
+   * @brief Check if the path is still being computed
+   *
+   * @return True until the planner has delivered the path
+   */
+  bool isPlanning();
+
+  /**
+   * @brief The path to follow, waiting for the planner if needed
+   *
+   * @return The points of the path
+   */
   std::vector<std::vector<float>> getPath();
 };
 
@@ -3,16 +3,23 @@
 
 #include <deque>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <set>
+#include <utility>
 #include <vector>
 
 #include "CompositeFactory.h"
 #include "Drone.h"
+#include "EntityStore.h"
 #include "IController.h"
 #include "IEntity.h"
+#include "PathPlanner.h"
 #include "Robot.h"
+#include "ThreadPool.h"
 #include "WeightDecorator.h"
 #include "graph.h"
+#include "routing/customizable_contraction_hierarchy.h"
 
 //--------------------  Model ----------------------------
 
@@ -35,10 +42,52 @@ class SimulationModel {
   ~SimulationModel();
 
   /**
-   * @brief Set the Graph for the SimulationModel
-   * @param graph Type IGraph* contain the new graph for SimulationModel
+   * @brief Set the Graph for the SimulationModel and prepares its contraction
+   * hierarchies and landmarks. The graph is shared, so one loaded map can back any number of
+   * models; setting the graph the model already uses does nothing. The graph
+   * must be set before any entity is created, as their routes refer to it.
+   * @param graph Shared handle to the new graph for SimulationModel
+   * @throws std::logic_error if the model already has entities
    **/
-  void setGraph(const routing::IGraph* graph) { this->graph = graph; }
+  void setGraph(std::shared_ptr<const routing::IGraph> graph);
+
+  /**
+   * @brief Sets how many threads update the entities
+   * @param threads Number of threads; 1 updates every entity on the thread
+   * calling update
+   **/
+  void setThreadCount(int threads);
+
+  /**
+   * @brief Sets how many background threads plan routes
+   * @param threads Number of threads; 0 plans every route inside the update
+   * that asks for it
+   **/
+  void setPlannerThreadCount(int threads);
+
+  /**
+   * @brief Sets whether routes planned with weights that have changed since
+   * are planned again from where the entity is
+   * @param replan True to replan such routes, false to keep following them
+   **/
+  void setReplanRoutes(bool replan);
+
+  /**
+   * @brief Whether routes are replanned after the road weights change
+   * @return True if they are replanned
+   **/
+  bool getReplanRoutes() const;
+
+  /**
+   * @brief Changes how long a road takes to travel. The road is the shortest
+   * path between the nodes nearest to "start" and "end"; its edges, in both
+   * directions, get their length times "factor", or are closed if "closed"
+   * is true. Only the customizable contraction hierarchy routes with the new
+   * weights.
+   * @param details Type JsonObject with the start and end of the road and
+   * its factor or closed flag
+   **/
+  void updateRoad(JsonObject& details);
 
   /**
    * @brief Creates a new simulation entity
@@ -62,7 +111,30 @@ class SimulationModel {
   void scheduleTrip(JsonObject& details);
 
   /**
-   * @brief Update the simulation
+   * @brief Hands scheduled deliveries to a carrier. While the entities are
+   * being updated the request is only recorded; it is granted once every
+   * entity is done, in order of carrier id, and the packages are returned by
+   * the carrier's next call.
+   * @param carrier The drone or dragon asking for work
+   * @param heavy Whether to take deliveries over 50 instead of light ones
+   * @param count Maximum number of packages to take
+   * @return The packages now carried by the carrier, possibly none
+   **/
+  std::vector<WeightDecorator*> takeDeliveries(const IEntity& carrier,
+                                               bool heavy, int count);
+
+  /**
+   * @brief Gives a package to its owner and tells the controller. During an
+   * update both happen once every entity is done.
+   * @param package The delivered package
+   * @param owner The robot receiving it
+   **/
+  void completeDelivery(WeightDecorator* package, Robot* owner);
+
+  /**
+   * @brief Update the simulation. The entities are updated first, in
+   * parallel if there are several threads, and the changes they make to
+   * shared state are applied afterwards on the calling thread.
    * @param dt Type double contain the time since update was last called.
    **/
   void update(double dt);
@@ -80,15 +152,73 @@ class SimulationModel {
    */
   const routing::IGraph* getGraph();
 
+  /**
+   * @brief Returns the contraction hierarchy prepared for the graph
+   *
+   * @returns The hierarchy, or nullptr if the graph could not be contracted
+   */
+  const routing::RoutingStrategy* getContractionHierarchy();
+
+  /**
+   * @brief Returns the customizable contraction hierarchy prepared for the
+   * graph, the one search that follows road updates
+   *
+   * @returns The hierarchy, or nullptr if the graph could not be contracted
+   */
+  const routing::RoutingStrategy* getCustomizableHierarchy();
+
+  /**
+   * @brief Returns the landmark guided A* prepared for the graph
+   *
+   * @returns The search, or nullptr if the graph has no landmarks
+   */
+  const routing::RoutingStrategy* getLandmarkAStar();
+
+  /**
+   * @brief Returns the planner that computes routes in the background
+   *
+   * @returns The planner, or nullptr if routes are planned synchronously
+   */
+  PathPlanner* getPathPlanner();
+
   std::deque<WeightDecorator*> scheduledDeliveries;
   std::vector<WeightDecorator*> scheduledDeliveriesOver50;
 
  protected:
+  /**
+   * @brief A carrier's request for deliveries made during an update
+   **/
+  struct Claim {
+    int carrier;
+    bool heavy;
+    int count;
+  };
+
+  std::vector<WeightDecorator*> popDeliveries(bool heavy, int count);
+  void commitUpdate();
+  void removeFromSim(int id);
+
   IController& controller;
-  std::map<int, IEntity*> entities;
+  EntityStore entities;
+  std::unique_ptr<ThreadPool> pool;
+  // true while entities are updated, possibly on several threads
+  bool updating = false;
+  // guards the three containers below during an update
+  std::mutex deferredMutex;
+  std::vector<Claim> claims;
+  std::map<int, std::vector<WeightDecorator*>> claimedDeliveries;
+  std::vector<std::pair<WeightDecorator*, Robot*>> completedDeliveries;
+  std::mutex removedMutex;
   std::set<int> removed;
-  void removeFromSim(int id);
-  const routing::IGraph* graph;
+  std::shared_ptr<const routing::IGraph> graph;
+  // refers into graph, so it is declared after it and destroyed first
+  std::unique_ptr<routing::RoutingStrategy> contractionHierarchy;
+  std::unique_ptr<routing::RoutingStrategy> landmarkAStar;
+  std::unique_ptr<routing::CustomizableContractionHierarchy>
+      customizableHierarchy;
+  bool replanRoutes = false;
+  // searches graph and the strategies above, so it is destroyed before them
+  std::unique_ptr<PathPlanner> planner;
   CompositeFactory entityFactory;
 };
 
@@ -0,0 +1,71 @@
+#ifndef THREAD_POOL_H_
+#define THREAD_POOL_H_
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Fixed set of threads running indexed loops with work stealing.
+ *
+ * parallelFor deals the indices out to one queue per thread in contiguous
+ * blocks. Each thread works through its own block from the back and, once
+ * it runs dry, steals from the front of the other queues, so a few slow
+ * items (a long path search, say) do not hold up the rest of the loop.
+ */
+class ThreadPool {
+ public:
+  /**
+   * @brief Starts the pool
+   * @param threads Number of threads working on a loop, counting the one
+   * that calls parallelFor
+   */
+  explicit ThreadPool(int threads);
+
+  /**
+   * @brief Stops and joins the worker threads
+   */
+  ~ThreadPool();
+
+  /**
+   * @brief Number of threads working on a loop
+   */
+  int getThreadCount() const { return queues.size(); }
+
+  /**
+   * @brief Runs task(i) for every i in [0, count) and waits for all of them.
+   * The first exception thrown by a task is rethrown here.
+   * @param count Number of items
+   * @param task Work for one item, called concurrently from several threads
+   */
+  void parallelFor(int count, const std::function<void(int)>& task);
+
+ private:
+  struct Queue {
+    std::mutex mutex;
+    std::deque<int> items;
+  };
+
+  void workerLoop(int self);
+  void work(int self);
+  bool pop(int self, int* item);
+  bool steal(int self, int* item);
+
+  std::vector<std::unique_ptr<Queue>> queues;
+  std::vector<std::thread> workers;
+  std::mutex mutex;
+  std::condition_variable wake;
+  std::condition_variable done;
+  const std::function<void(int)>* job = nullptr;
+  std::exception_ptr error;
+  int generation = 0;
+  int busy = 0;
+  bool stopping = false;
+};
+
+#endif  // THREAD_POOL_H_
@@ -23,7 +23,6 @@ class WeightDecorator : public IEntity {
 
   // Override functions from IEntity
   Vector3 getDestination() const;
-  Vector3 getPosition() const;
   std::string getStrategyName() const;
   void setStrategyName(std::string strategyName_);
   void update(double dt);
@@ -51,6 +50,5 @@ class WeightDecorator : public IEntity {
  private:
   Package* package;  // Pointer to the wrapped Package object
   double weight;     // Additional attribute
-  Vector3 position = package->getPosition();
 };
 #endif
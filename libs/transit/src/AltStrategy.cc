@@ -0,0 +1,23 @@
+#include "AltStrategy.h"
+
+#include "routing/astar.h"
+
+/**
+ * @brief Constructs an AltStrategy object.
+ *
+ * Computes the path with A* guided by the landmark distances that were
+ * precomputed when the graph was loaded. The landmarks give much tighter
+ * estimates than the straight-line distance around rivers and buildings, so
+ * the search expands fewer nodes for the same path length.
+ *
+ * @param pos Starting position of the entity in Vector3 format.
+ * @param des Destination position of the entity in Vector3 format.
+ * @param g Pointer to the graph interface used for pathfinding.
+ * @param alt Landmark guided A* for g, or nullptr to use A*.
+ * @param planner Planner running the search in the background, or nullptr.
+ */
+AltStrategy::AltStrategy(Vector3 pos, Vector3 des, const routing::IGraph* g,
+                         const routing::RoutingStrategy* alt,
+                         PathPlanner* planner) {
+  plan(pos, des, g, alt ? *alt : routing::AStar::Default(), planner);
+}
@@ -13,14 +13,9 @@
  * @param pos Starting position of the entity in Vector3 format.
  * @param des Destination position of the entity in Vector3 format.
  * @param g Pointer to the graph interface used for pathfinding.
+ * @param planner Planner running the search in the background, or nullptr.
  */
 AstarStrategy::AstarStrategy(Vector3 pos, Vector3 des,
-                             const routing::IGraph* g) {
-  std::vector<float> start = {static_cast<float>(pos[0]),
-                              static_cast<float>(pos[1]),
-                              static_cast<float>(pos[2])};
-  std::vector<float> end = {static_cast<float>(des[0]),
-                            static_cast<float>(des[1]),
-                            static_cast<float>(des[2])};
-  path = g->GetPath(start, end, routing::AStar::Default());
+                             const routing::IGraph* g, PathPlanner* planner) {
+  plan(pos, des, g, routing::AStar::Default(), planner);
 }
@@ -186,13 +186,13 @@ void BatteryDecorator::chargeBattery(double dt) {
   }
   if (go) {
     std::cout << "on my way go to the charger" << std::endl;
-    go->move(decoratedDrone, dt);
+    double left = go->move(decoratedDrone, dt);
     batteryLevel -= stationaryConsumptionRate * dt;
     if (go->isCompleted()) {
       batteryLevel = 100;
       std::cout << "fully chagred" << std::endl;
       if (back) {
-        back->move(decoratedDrone, dt);
+        back->move(decoratedDrone, left);
         std::cout << "on my way back to the work" << std::endl;
         batteryLevel -= stationaryConsumptionRate * dt;
         if (back->isCompleted()) {
@@ -0,0 +1,20 @@
+#include "BidirectionalAstarStrategy.h"
+
+#include "routing/bidirectional_astar.h"
+
+/**
+ * @brief Constructs a BidirectionalAstarStrategy object.
+ *
+ * Computes the path with an A* search that runs from the start and from the
+ * destination at the same time and stops once the two meet on a shortest
+ * path. It finds paths as short as AstarStrategy's.
+ *
+ * @param pos Starting position of the entity in Vector3 format.
+ * @param des Destination position of the entity in Vector3 format.
+ * @param g Pointer to the graph interface used for pathfinding.
+ * @param planner Planner running the search in the background, or nullptr.
+ */
+BidirectionalAstarStrategy::BidirectionalAstarStrategy(
+    Vector3 pos, Vector3 des, const routing::IGraph* g, PathPlanner* planner) {
+  plan(pos, des, g, routing::BidirectionalAStar::Default(), planner);
+}
@@ -0,0 +1,20 @@
+#include "BidirectionalDijkstraStrategy.h"
+
+#include "routing/bidirectional_dijkstra.h"
+
+/**
+ * @brief Constructs a BidirectionalDijkstraStrategy object.
+ *
+ * Computes the shortest path with two Dijkstra searches, one growing from the
+ * start and one from the destination, which usually settle far fewer nodes
+ * together than a single search from the start.
+ *
+ * @param pos Starting position of the entity in Vector3 format.
+ * @param des Destination position of the entity in Vector3 format.
+ * @param g Pointer to the graph interface used for pathfinding.
+ * @param planner Planner running the search in the background, or nullptr.
+ */
+BidirectionalDijkstraStrategy::BidirectionalDijkstraStrategy(
+    Vector3 pos, Vector3 des, const routing::IGraph* g, PathPlanner* planner) {
+  plan(pos, des, g, routing::BidirectionalDijkstra::Instance(), planner);
+}
@@ -0,0 +1,25 @@
+#include "ChStrategy.h"
+
+#include "routing/dijkstra.h"
+
+/**
+ * @brief Constructs a ChStrategy object.
+ *
+ * Initializes the ChStrategy by converting the starting and ending positions
+ * from Vector3 to std::vector<float> and then computing the path over the
+ * contraction hierarchy that was prepared when the graph was loaded. The
+ * resulting path is the same shortest path Dijkstra's algorithm would find,
+ * at a fraction of the query cost.
+ *
+ * @param pos Starting position of the entity in Vector3 format.
+ * @param des Destination position of the entity in Vector3 format.
+ * @param g Pointer to the graph interface used for pathfinding.
+ * @param hierarchy Contraction hierarchy of g, or nullptr to use Dijkstra.
+ * @param planner Planner running the search in the background, or nullptr.
+ */
+ChStrategy::ChStrategy(Vector3 pos, Vector3 des, const routing::IGraph* g,
+                       const routing::RoutingStrategy* hierarchy,
+                       PathPlanner* planner) {
+  plan(pos, des, g, hierarchy ? *hierarchy : routing::Dijkstra::Instance(),
+       planner);
+}
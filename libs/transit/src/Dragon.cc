@@ -4,9 +4,13 @@
 #include <cmath>
 #include <limits>
 
+#include "AltStrategy.h"
 #include "AstarStrategy.h"
 #include "BeelineStrategy.h"
 #include "BfsStrategy.h"
+#include "BidirectionalAstarStrategy.h"
+#include "BidirectionalDijkstraStrategy.h"
+#include "ChStrategy.h"
 #include "DfsStrategy.h"
 #include "DijkstraStrategy.h"
 #include "JumpDecorator.h"
@@ -46,12 +50,13 @@ void Dragon::getNextDelivery() {
   std::vector<Vector3> packagePosition;
   std::vector<Vector3> finalDestination;
 
-  int numDeliveries =
-      std::min(static_cast<int>(model->scheduledDeliveriesOver50.size()),
-               this->maxCapacity);
+  if (!model) return;
+  const routing::IGraph* graph = model->getGraph();
+  PathPlanner* planner = model->getPathPlanner();
+  packages = model->takeDeliveries(*this, true, this->maxCapacity);
+  int numDeliveries = packages.size();
   this->currentLoad = numDeliveries;
 
-  packages.resize(numDeliveries, nullptr);
   toPackage.resize(numDeliveries, nullptr);
   toFinalDestination.resize(numDeliveries, nullptr);
   pickedUp.resize(numDeliveries, false);
@@ -64,14 +69,6 @@ void Dragon::getNextDelivery() {
     fullLoaded = false;
   }
 
-  for (int i = 0; i < currentLoad; i++) {
-    if (model && !model->scheduledDeliveriesOver50.empty()) {
-      packages.at(i) = model->scheduledDeliveriesOver50.front();
-      model->scheduledDeliveriesOver50.erase(
-          model->scheduledDeliveriesOver50.begin());
-    }
-  }
-
   for (int i = 0; i < this->currentLoad; i++) {
     if (packages.at(i)) {
       available = false;
@@ -80,24 +77,46 @@ void Dragon::getNextDelivery() {
       packagePosition.at(i) = packages.at(i)->getPosition();
       finalDestination.at(i) = packages.at(i)->getDestination();
 
-      toPackage.at(i) = new BeelineStrategy(position, packagePosition.at(i));
+      toPackage.at(i) = new BeelineStrategy(getPosition(), packagePosition.at(i));
 
       std::string strat = packages.at(i)->getStrategyName();
       if (strat == "astar") {
         toFinalDestination.at(i) = new JumpDecorator(new AstarStrategy(
-            packagePosition.at(i), finalDestination.at(i), model->getGraph()));
+            packagePosition.at(i), finalDestination.at(i), graph, planner));
       } else if (strat == "dfs") {
         toFinalDestination.at(i) = new SpinDecorator(new JumpDecorator(
             new DfsStrategy(packagePosition.at(i), finalDestination.at(i),
-                            model->getGraph())));
+                            graph, planner)));
       } else if (strat == "bfs") {
         toFinalDestination.at(i) = new SpinDecorator(new SpinDecorator(
             new BfsStrategy(packagePosition.at(i), finalDestination.at(i),
-                            model->getGraph())));
+                            graph, planner)));
       } else if (strat == "dijkstra") {
         toFinalDestination.at(i) = new JumpDecorator(new SpinDecorator(
             new DijkstraStrategy(packagePosition.at(i), finalDestination.at(i),
-                                 model->getGraph())));
+                                 graph, planner)));
+      } else if (strat == "bastar") {
+        toFinalDestination.at(i) = new JumpDecorator(
+            new BidirectionalAstarStrategy(packagePosition.at(i),
+                                           finalDestination.at(i), graph,
+                                           planner));
+      } else if (strat == "bdijkstra") {
+        toFinalDestination.at(i) = new JumpDecorator(new SpinDecorator(
+            new BidirectionalDijkstraStrategy(packagePosition.at(i),
+                                              finalDestination.at(i), graph,
+                                              planner)));
+      } else if (strat == "alt") {
+        toFinalDestination.at(i) = new JumpDecorator(new AltStrategy(
+            packagePosition.at(i), finalDestination.at(i), graph,
+            model->getLandmarkAStar(), planner));
+      } else if (strat == "ch") {
+        toFinalDestination.at(i) = new SpinDecorator(new ChStrategy(
+            packagePosition.at(i), finalDestination.at(i), graph,
+            model->getContractionHierarchy(), planner));
+      } else if (strat == "cch") {
+        toFinalDestination.at(i) = new SpinDecorator(new ChStrategy(
+            packagePosition.at(i), finalDestination.at(i), graph,
+            model->getCustomizableHierarchy(), planner));
       } else {
         toFinalDestination.at(i) =
             new BeelineStrategy(packagePosition.at(i), finalDestination.at(i));
@@ -106,92 +125,55 @@ void Dragon::getNextDelivery() {
   }
 }
 
-// void Dragon::update(double dt) {
-//     if (available)
-//         getNextDelivery();
-
-//     if (this->currentLoad > 0) {
-//         if (toPackage.at(packageIndex)) {
-//             toPackage.at(packageIndex)->move(this, dt);
-
-//             if (toPackage.at(packageIndex)->isCompleted()) {
-//                 delete toPackage.at(packageIndex);
-//                 toPackage.at(packageIndex) = nullptr;
-//                 pickedUp.at(packageIndex) = true;
-//             }
-//         } else if (toFinalDestination.at(packageIndex)) {
-//             toFinalDestination.at(packageIndex)->move(this, dt);
-
-//             if (packages.at(packageIndex) && pickedUp.at(packageIndex)) {
-//                 packages.at(packageIndex)->setPosition(position);
-//                 packages.at(packageIndex)->setDirection(direction);
-//             }
-
-//             if (toFinalDestination.at(packageIndex)->isCompleted()) {
-//                 delete toFinalDestination.at(packageIndex);
-//                 toFinalDestination.at(packageIndex) = nullptr;
-//                 packages.at(packageIndex)->handOff();
-//                 packages.at(packageIndex) = nullptr;
-//                 pickedUp.at(packageIndex) = false;
-//                 this->currentLoad--;
-//                 packageIndex++;
-//             }
-
-//             if (this->currentLoad == 0) {
-//                 available = true;
-//                 packageIndex = 0;
-//             }
-//         }
-//     }
-// }
-
 /**
  * @brief Update the state of the Dragon.
  *
  * This method updates the Dragon's state based on the time delta. It handles
  * the delivery process, including moving towards packages and final
- * destinations, and updating package positions.
+ * destinations, and updating package positions. A long update can finish
+ * several legs of the current load, each one starting with the time the
+ * previous one left over.
  *
  * @param dt Time delta for updating the state.
  */
 void Dragon::update(double dt) {
   if (available) getNextDelivery();
 
-  if (this->currentLoad > 0) {
+  while (this->currentLoad > 0 && dt > 0) {
     if (numPicked != this->currentLoad && toPackage.at(packageIndex)) {
       if (numPicked > 0) {
-        packages.at(tempPickedIndex)->setPosition(position);
-        packages.at(tempPickedIndex)->setDirection(direction);
+        packages.at(tempPickedIndex)->setPosition(getPosition());
+        packages.at(tempPickedIndex)->setDirection(getDirection());
       }
-      toPackage.at(packageIndex)->move(this, dt);
+      dt = toPackage.at(packageIndex)->move(this, dt);
       if (toPackage.at(packageIndex)->isCompleted()) {
         delete toPackage.at(packageIndex);
         toPackage.at(packageIndex) = nullptr;
         pickedUp.at(packageIndex) = true;
         if (packages.at(packageIndex) && pickedUp.at(packageIndex)) {
-          packages.at(packageIndex)->setPosition(position);
-          packages.at(packageIndex)->setDirection(direction);
+          packages.at(packageIndex)->setPosition(getPosition());
+          packages.at(packageIndex)->setDirection(getDirection());
         }
         packageIndex++;
         numPicked++;
       }
     } else if (numPicked == this->currentLoad &&
              toFinalDestination.at(packageIndex2)) {
-      toFinalDestination.at(packageIndex2)->move(this, dt);
+      dt = toFinalDestination.at(packageIndex2)->move(this, dt);
       if (this->currentLoad == 2) {
-        packages.at(tempPickedIndex)->setPosition(position);
-        packages.at(tempPickedIndex)->setDirection(direction);
+        packages.at(tempPickedIndex)->setPosition(getPosition());
+        packages.at(tempPickedIndex)->setDirection(getDirection());
       }
       if (this->currentLoad != 1) {
-        packages.at(1)->setPosition(position);
-        packages.at(1)->setDirection(direction);
+        packages.at(1)->setPosition(getPosition());
+        packages.at(1)->setDirection(getDirection());
       }
       if (this->currentLoad == 1 && !fullLoaded) {
-        packages.at(tempPickedIndex)->setPosition(position);
-        packages.at(tempPickedIndex)->setDirection(direction);
+        packages.at(tempPickedIndex)->setPosition(getPosition());
+        packages.at(tempPickedIndex)->setDirection(getDirection());
       } else if (this->currentLoad == 1) {
-        packages.at(1)->setPosition(position);
-        packages.at(1)->setDirection(direction);
+        packages.at(1)->setPosition(getPosition());
+        packages.at(1)->setDirection(getDirection());
       }
 
       if (toFinalDestination.at(packageIndex2)->isCompleted()) {
@@ -209,6 +191,8 @@ void Dragon::update(double dt) {
         packageIndex = 0;
         packageIndex2 = 0;
       }
+    } else {
+      break;
     }
   }
 }
@@ -4,9 +4,13 @@
 #include <cmath>
 #include <limits>
 
+#include "AltStrategy.h"
 #include "AstarStrategy.h"
 #include "BeelineStrategy.h"
 #include "BfsStrategy.h"
+#include "BidirectionalAstarStrategy.h"
+#include "BidirectionalDijkstraStrategy.h"
+#include "ChStrategy.h"
 #include "DfsStrategy.h"
 #include "DijkstraStrategy.h"
 #include "JumpDecorator.h"
@@ -43,10 +47,10 @@ Drone::~Drone() {
  * pathfinding strategies for reaching the package and its final destination.
  */
 void Drone::getNextDelivery() {
-  if (model && model->scheduledDeliveries.size() > 0 &&
-      model->scheduledDeliveries.front()->getWeight() <= 50) {
-    package = model->scheduledDeliveries.front();
-    model->scheduledDeliveries.pop_front();
+  if (model) {
+    std::vector<WeightDecorator*> taken =
+        model->takeDeliveries(*this, false, 1);
+    if (!taken.empty()) package = taken.front();
 
     if (package) {
       available = false;
@@ -54,25 +58,46 @@ void Drone::getNextDelivery() {
 
       Vector3 packagePosition = package->getPosition();
       Vector3 finalDestination = package->getDestination();
+      const routing::IGraph* graph = model->getGraph();
+      PathPlanner* planner = model->getPathPlanner();
 
-      toPackage = new BeelineStrategy(position, packagePosition);
+      toPackage = new BeelineStrategy(getPosition(), packagePosition);
 
       std::string strat = package->getStrategyName();
       if (strat == "astar") {
         toFinalDestination = new JumpDecorator(new AstarStrategy(
-            packagePosition, finalDestination, model->getGraph()));
+            packagePosition, finalDestination, graph, planner));
       } else if (strat == "dfs") {
         toFinalDestination =
             new SpinDecorator(new JumpDecorator(new DfsStrategy(
-                packagePosition, finalDestination, model->getGraph())));
+                packagePosition, finalDestination, graph, planner)));
       } else if (strat == "bfs") {
         toFinalDestination =
             new SpinDecorator(new SpinDecorator(new BfsStrategy(
-                packagePosition, finalDestination, model->getGraph())));
+                packagePosition, finalDestination, graph, planner)));
       } else if (strat == "dijkstra") {
         toFinalDestination =
             new JumpDecorator(new SpinDecorator(new DijkstraStrategy(
-                packagePosition, finalDestination, model->getGraph())));
+                packagePosition, finalDestination, graph, planner)));
+      } else if (strat == "bastar") {
+        toFinalDestination = new JumpDecorator(new BidirectionalAstarStrategy(
+            packagePosition, finalDestination, graph, planner));
+      } else if (strat == "bdijkstra") {
+        toFinalDestination = new JumpDecorator(
+            new SpinDecorator(new BidirectionalDijkstraStrategy(
+                packagePosition, finalDestination, graph, planner)));
+      } else if (strat == "alt") {
+        toFinalDestination = new JumpDecorator(
+            new AltStrategy(packagePosition, finalDestination, graph,
+                            model->getLandmarkAStar(), planner));
+      } else if (strat == "ch") {
+        toFinalDestination = new SpinDecorator(
+            new ChStrategy(packagePosition, finalDestination, graph,
+                           model->getContractionHierarchy(), planner));
+      } else if (strat == "cch") {
+        toFinalDestination = new SpinDecorator(
+            new ChStrategy(packagePosition, finalDestination, graph,
+                           model->getCustomizableHierarchy(), planner));
       } else {
         toFinalDestination =
             new BeelineStrategy(packagePosition, finalDestination);
@@ -86,7 +111,8 @@ void Drone::getNextDelivery() {
  *
  * This method updates the Drone's state based on the time delta. It handles the
  * delivery process, including moving towards the package and final destination,
- * and updating package positions.
+ * and updating package positions. Time left over after reaching the package
+ * carries on towards the destination in the same update.
  *
  * @param dt Time delta for updating the state.
  */
@@ -94,7 +120,7 @@ void Drone::update(double dt) {
   if (available) getNextDelivery();
 
   if (toPackage) {
-    toPackage->move(this, dt);
+    dt = toPackage->move(this, dt);
     if (moving == false) {
       moving = true;
     }
@@ -105,14 +131,15 @@ void Drone::update(double dt) {
       pickedUp = true;
       moving = false;
     }
-  } else if (toFinalDestination) {
+  }
+  if (!toPackage && toFinalDestination) {
     toFinalDestination->move(this, dt);
     if (moving == false) {
       moving = true;
     }
     if (package && pickedUp) {
-      package->setPosition(position);
-      package->setDirection(direction);
+      package->setPosition(getPosition());
+      package->setDirection(getDirection());
     }
 
     if (toFinalDestination->isCompleted()) {
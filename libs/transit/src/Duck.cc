@@ -17,7 +17,7 @@ Duck::Duck(JsonObject& obj) : IEntity(obj) {
 
   // dest = Vector3(x,y,z);
   // this->toFinalDestination = new AstarStrategy(start, dest,
-  // model->getGraph());
+  // model->getGraph(), planner);
 }
 
 /**
@@ -43,25 +43,33 @@ Duck::~Duck() {
 void Duck::update(double dt) {
   if (toFinalDestination == nullptr) {
     start = this->getPosition();
-    std::srand(std::time(0));
-    double x = -1400 + std::rand() % (1500 - (-1400) + 1);
-    double y = 240 + std::rand() % (300 - 240 + 1);
-    double z = -800 + std::rand() % (800 - (-800) + 1);
-
-    dest = Vector3(x, y, z);
+    dest = randomDestination();
     this->toFinalDestination =
-        new AstarStrategy(start, dest, model->getGraph());
+        new AstarStrategy(start, dest, model->getGraph(),
+                          model->getPathPlanner());
   }
   if (!(toFinalDestination->isCompleted())) {
     toFinalDestination->move(this, dt);
   } else {
     delete toFinalDestination;
-    int x = -1400 + std::rand() % (1500 - (-1400) + 1);
-    int y = 240 + std::rand() % (300 - 240 + 1);
-    int z = -800 + std::rand() % (800 - (-800) + 1);
     start = dest;
-    dest = Vector3(x, y, z);
+    dest = randomDestination();
     this->toFinalDestination =
-        new AstarStrategy(start, dest, model->getGraph());
+        new AstarStrategy(start, dest, model->getGraph(),
+                          model->getPathPlanner());
   }
 }
+
+/**
+ * @brief Picks a random point on the map for the Duck to fly to.
+ *
+ * The coordinates are whole numbers drawn from the Duck's own generator.
+ *
+ * @return The destination.
+ */
+Vector3 Duck::randomDestination() {
+  std::uniform_int_distribution<int> x(-1400, 1500);
+  std::uniform_int_distribution<int> y(240, 300);
+  std::uniform_int_distribution<int> z(-800, 800);
+  return Vector3(x(generator), y(generator), z(generator));
+}
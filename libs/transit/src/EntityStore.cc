@@ -0,0 +1,132 @@
+#include "EntityStore.h"
+
+#include <stdexcept>
+#include <typeinfo>
+
+#include "IEntity.h"
+
+/**
+ * @brief Adds an entity to the group of its concrete type.
+ *
+ * A free slot is reused if there is one, with its generation bumped so the
+ * ids of earlier occupants stay invalid. The entity's current kinematic state
+ * is copied into the arrays before the entity is attached to its slot.
+ *
+ * @param entity The entity to add.
+ * @return The id of the entity.
+ */
+int EntityStore::insert(IEntity* entity) {
+  auto found = kindOf.find(std::type_index(typeid(*entity)));
+  uint32_t kindIndex;
+  if (found == kindOf.end()) {
+    kindIndex = kinds.size();
+    kinds.emplace_back();
+    kindOf[std::type_index(typeid(*entity))] = kindIndex;
+  } else {
+    kindIndex = found->second;
+  }
+
+  uint32_t slot;
+  if (!freeSlots.empty()) {
+    slot = freeSlots.back();
+    freeSlots.pop_back();
+    slots[slot].generation = (slots[slot].generation + 1) & generationMask;
+  } else {
+    if (slots.size() > slotMask) {
+      throw std::length_error("too many entities");
+    }
+    slot = slots.size();
+    slots.push_back(Slot{0, 0, 0, false});
+  }
+
+  Kind& kind = kinds[kindIndex];
+  slots[slot].kind = kindIndex;
+  slots[slot].index = kind.entities.size();
+  slots[slot].used = true;
+  kind.entities.push_back(entity);
+  kind.positions.push_back(entity->getPosition());
+  kind.directions.push_back(entity->getDirection());
+  kind.speeds.push_back(entity->getSpeed());
+  kind.slots.push_back(slot);
+  count++;
+
+  int id = static_cast<int>(slot | (slots[slot].generation << slotBits));
+  entity->attach(this, slot, id);
+  return id;
+}
+
+/**
+ * @brief Removes an entity by moving the last entity of its kind into its
+ * place.
+ *
+ * The entity gets its kinematic state back, so it can still be used after
+ * leaving the store.
+ *
+ * @param id Id of the entity.
+ * @return The entity, or nullptr if the id is unknown.
+ */
+IEntity* EntityStore::remove(int id) {
+  uint32_t slot;
+  if (!find(id, &slot)) return nullptr;
+
+  Kind& kind = at(slot);
+  uint32_t index = slots[slot].index;
+  IEntity* entity = kind.entities[index];
+  Vector3 position = kind.positions[index];
+  Vector3 direction = kind.directions[index];
+  double speed = kind.speeds[index];
+
+  uint32_t last = kind.entities.size() - 1;
+  if (index != last) {
+    kind.entities[index] = kind.entities[last];
+    kind.positions[index] = kind.positions[last];
+    kind.directions[index] = kind.directions[last];
+    kind.speeds[index] = kind.speeds[last];
+    kind.slots[index] = kind.slots[last];
+    slots[kind.slots[index]].index = index;
+  }
+  kind.entities.pop_back();
+  kind.positions.pop_back();
+  kind.directions.pop_back();
+  kind.speeds.pop_back();
+  kind.slots.pop_back();
+
+  slots[slot].used = false;
+  freeSlots.push_back(slot);
+  count--;
+
+  entity->detach(position, direction, speed);
+  return entity;
+}
+
+/**
+ * @brief Looks up an entity by id.
+ *
+ * @param id Id of the entity.
+ * @return The entity, or nullptr if the id is unknown.
+ */
+IEntity* EntityStore::get(int id) const {
+  uint32_t slot;
+  if (!find(id, &slot)) return nullptr;
+  return at(slot).entities[slots[slot].index];
+}
+
+/**
+ * @brief Resolves an id to its slot, checking the slot is still held by the
+ * same entity.
+ *
+ * @param id Id of the entity.
+ * @param slot Receives the slot of the entity.
+ * @return True if the id belongs to an entity in the store.
+ */
+bool EntityStore::find(int id, uint32_t* slot) const {
+  if (id < 0) return false;
+  uint32_t s = static_cast<uint32_t>(id) & slotMask;
+  uint32_t generation = static_cast<uint32_t>(id) >> slotBits;
+  if (s >= slots.size() || !slots[s].used ||
+      slots[s].generation != generation) {
+    return false;
+  }
+  *slot = s;
+  return true;
+}
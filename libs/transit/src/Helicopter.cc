@@ -39,10 +39,11 @@ void Helicopter::update(double dt) {
     movement->move(this, dt);
   } else {
     if (movement) delete movement;
+    std::uniform_real_distribution<double> unit(0, 1);
     Vector3 dest;
-    dest.x = ((static_cast<double>(rand())) / RAND_MAX) * (2900) - 1400;
-    dest.y = position.y;
-    dest.z = ((static_cast<double>(rand())) / RAND_MAX) * (1600) - 800;
-    movement = new BeelineStrategy(position, dest);
+    dest.x = unit(generator) * (2900) - 1400;
+    dest.y = getPosition().y;
+    dest.z = unit(generator) * (1600) - 800;
+    movement = new BeelineStrategy(getPosition(), dest);
   }
 }
@@ -40,10 +40,14 @@ void Human::update(double dt) {
     movement->move(this, dt);
   } else {
     if (movement) delete movement;
+    std::uniform_real_distribution<double> unit(0, 1);
     Vector3 dest;
-    dest.x = ((static_cast<double>(rand())) / RAND_MAX) * (2900) - 1400;
-    dest.y = position.y;
-    dest.z = ((static_cast<double>(rand())) / RAND_MAX) * (1600) - 800;
-    if (model) movement = new AstarStrategy(position, dest, model->getGraph());
+    dest.x = unit(generator) * (2900) - 1400;
+    dest.y = getPosition().y;
+    dest.z = unit(generator) * (1600) - 800;
+    if (model) {
+      movement = new AstarStrategy(getPosition(), dest, model->getGraph(),
+                                   model->getPathPlanner());
+    }
   }
 }
@@ -1,5 +1,7 @@
 #include "ICelebrationDecorator.h"
 
+#include <algorithm>
+
 /**
  * @brief Construct a new ICelebrationDecorator object.
  *
@@ -30,18 +32,24 @@ ICelebrationDecorator::~ICelebrationDecorator() {
  * behavior.
  *
  * First, the method applies the underlying strategy. Once the strategy is
- * completed, it starts the celebration behavior for the specified duration.
+ * completed, the time it left over goes to the celebration, which runs for
+ * exactly the specified duration.
  *
  * @param entity Entity to move.
  * @param dt Delta time for the movement and celebration updates.
+ * @return Time left over after the celebration ended.
  */
-void ICelebrationDecorator::move(IEntity* entity, double dt) {
+double ICelebrationDecorator::move(IEntity* entity, double dt) {
   if (!strategy->isCompleted()) {
-    strategy->move(entity, dt);
-  } else if (!isCompleted()) {
-    celebrate(entity, dt);
-    time -= dt;
+    dt = strategy->move(entity, dt);
+  }
+  if (strategy->isCompleted() && !isCompleted() && dt > 0) {
+    double step = std::min(dt, static_cast<double>(time));
+    celebrate(entity, step);
+    time -= step;
+    dt -= step;
   }
+  return isCompleted() ? dt : 0;
 }
 
 /**
@@ -1,5 +1,7 @@
 #include "IEntity.h"
 
+#include "EntityStore.h"
+
 /**
  * @brief Default constructor for IEntity.
  *
@@ -47,6 +49,13 @@ IEntity::~IEntity() {}
  */
 void IEntity::linkModel(SimulationModel* model) { this->model = model; }
 
+/**
+ * @brief Get the simulation model the entity is linked to.
+ *
+ * @return Pointer to the model, or nullptr before linkModel is called.
+ */
+SimulationModel* IEntity::getModel() const { return model; }
+
 /**
  * @brief Get the current id of the entity.
  *
@@ -59,14 +68,18 @@ int IEntity::getId() const { return id; }
  *
  * @return Vector3 representing the current position of the entity.
  */
-Vector3 IEntity::getPosition() const { return position; }
+Vector3 IEntity::getPosition() const {
+  return store ? store->getPosition(slot) : position;
+}
 
 /**
  * @brief Get the current direction of the entity.
  *
  * @return Vector3 representing the current direction of the entity.
  */
-Vector3 IEntity::getDirection() const { return direction; }
+Vector3 IEntity::getDirection() const {
+  return store ? store->getDirection(slot) : direction;
+}
 
 /**
  * @brief Get the current details of the entity.
@@ -94,21 +107,35 @@ std::string IEntity::getName() const { return name; }
  *
  * @return Vector3 representing the current speed of the entity.
  */
-double IEntity::getSpeed() const { return speed; }
+double IEntity::getSpeed() const {
+  return store ? store->getSpeed(slot) : speed;
+}
 
 /**
  * @brief Set the position of the entity.
  *
  * @param pos_ Vector3 representing the new position of the entity.
  */
-void IEntity::setPosition(Vector3 pos_) { position = pos_; }
+void IEntity::setPosition(Vector3 pos_) {
+  if (store) {
+    store->setPosition(slot, pos_);
+  } else {
+    position = pos_;
+  }
+}
 
 /**
  * @brief Set the direction of the entity.
  *
  * @param pos_ Vector3 representing the new direction of the entity.
  */
-void IEntity::setDirection(Vector3 dir_) { direction = dir_; }
+void IEntity::setDirection(Vector3 dir_) {
+  if (store) {
+    store->setDirection(slot, dir_);
+  } else {
+    direction = dir_;
+  }
+}
 
 /**
  * @brief Set the color of the entity.
@@ -126,7 +153,37 @@ void IEntity::setColor(std::string col_) { color = col_; }
  * @param angle Angle in radians to rotate the entity.
  */
 void IEntity::rotate(double angle) {
-  Vector3 dirTmp = direction;
-  direction.x = dirTmp.x * std::cos(angle) - dirTmp.z * std::sin(angle);
-  direction.z = dirTmp.x * std::sin(angle) + dirTmp.z * std::cos(angle);
+  Vector3 dirTmp = getDirection();
+  Vector3 dir = dirTmp;
+  dir.x = dirTmp.x * std::cos(angle) - dirTmp.z * std::sin(angle);
+  dir.z = dirTmp.x * std::sin(angle) + dirTmp.z * std::cos(angle);
+  setDirection(dir);
+}
+
+/**
+ * @brief Attach the IEntity to the slot an EntityStore gave it.
+ *
+ * @param store The store now holding the entity's kinematic state.
+ * @param slot The entity's slot in the store.
+ * @param id The id assigned by the store.
+ */
+void IEntity::attach(EntityStore* store, uint32_t slot, int id) {
+  this->store = store;
+  this->slot = slot;
+  this->id = id;
+  generator.seed(id);
+}
+
+/**
+ * @brief Detach the IEntity from its store, taking back its state.
+ *
+ * @param position The entity's last position.
+ * @param direction The entity's last direction.
+ * @param speed The entity's speed.
+ */
+void IEntity::detach(Vector3 position, Vector3 direction, double speed) {
+  store = nullptr;
+  this->position = position;
+  this->direction = direction;
+  this->speed = speed;
 }
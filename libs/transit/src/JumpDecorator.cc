@@ -1,5 +1,8 @@
 #include "JumpDecorator.h"
 
+#include <algorithm>
+#include <cmath>
+
 /**
  * @brief Construct a new JumpDecorator object.
  *
@@ -20,19 +23,29 @@ JumpDecorator::JumpDecorator(IStrategy* strategy, double time,
  *
  * This method updates the entity's position to simulate a jumping motion. The
  * entity moves up to the specified jump height and then descends back down.
+ * Whole bounces leave the entity where it started, so only the remainder of
+ * the distance travelled in dt is applied.
  *
  * @param entity Entity to apply the jumping behavior to.
  * @param dt Delta time for the update.
  */
 void JumpDecorator::celebrate(IEntity* entity, double dt) {
-  Vector3 step(0, entity->getSpeed() * dt, 0);
-  if (up) {
-    h += step.y;
-    entity->setPosition(entity->getPosition() + step);
-    if (h >= jumpHeight) up = false;
-  } else {
-    h -= step.y;
-    entity->setPosition(entity->getPosition() - step);
-    if (h <= 0) up = true;
+  if (jumpHeight <= 0) return;
+
+  double distance = std::fmod(entity->getSpeed() * dt, 2 * jumpHeight);
+  double start = h;
+  while (distance > 0) {
+    if (up) {
+      double leg = std::min(distance, jumpHeight - h);
+      h += leg;
+      distance -= leg;
+      if (h >= jumpHeight) up = false;
+    } else {
+      double leg = std::min(distance, h);
+      h -= leg;
+      distance -= leg;
+      if (h <= 0) up = true;
+    }
   }
+  entity->setPosition(entity->getPosition() + Vector3(0, h - start, 0));
 }
@@ -13,8 +13,6 @@
 Package::Package(JsonObject& obj) : IEntity(obj) {
   std::string n = details["name"];
   name = n;
-  JsonArray pos(details["position"]);
-  position = {pos[0], pos[1], pos[2]};
 }
 
 /**
@@ -47,13 +45,6 @@ void Package::setStrategyName(std::string strategyName_) {
  */
 std::string Package::getName() { return name; }
 
-/**
- * @brief Retrieves the current position of the package.
- *
- * @return The position of the package as a Vector3 object.
- */
-Vector3 Package::getPosition() const { return position; }
-
 /**
  * @brief Updates the package's state. This method is currently a placeholder
  * and does not perform any operation.
@@ -62,13 +53,6 @@ Vector3 Package::getPosition() const { return position; }
  */
 void Package::update(double dt) {}
 
-/**
- * @brief Sets the position of the package.
- *
- * @param pos_ The new position of the package as a Vector3 object.
- */
-void Package::setPosition(Vector3 pos_) { position = pos_; }
-
 /**
  * @brief Initializes the delivery process of the package.
  *
@@ -0,0 +1,72 @@
+#include "PathPlanner.h"
+
+/**
+ * @brief Starts the worker threads of the planner.
+ *
+ * @param threads Number of worker threads.
+ */
+PathPlanner::PathPlanner(int threads) {
+  if (threads < 1) threads = 1;
+  for (int i = 0; i < threads; i++) {
+    workers.emplace_back(&PathPlanner::workerLoop, this);
+  }
+}
+
+/**
+ * @brief Lets the workers answer what is still queued, then joins them.
+ */
+PathPlanner::~PathPlanner() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  wake.notify_all();
+  for (std::thread& worker : workers) {
+    worker.join();
+  }
+}
+
+/**
+ * @brief Queues a route request for the workers.
+ *
+ * A search that throws makes the future rethrow the exception.
+ *
+ * @param start Start of the route.
+ * @param end End of the route.
+ * @param graph Graph to route on.
+ * @param strategy Search used on the graph.
+ * @return A future holding the route.
+ */
+std::shared_future<PathPlanner::Path> PathPlanner::plan(
+    std::vector<float> start, std::vector<float> end,
+    const routing::IGraph* graph, const routing::RoutingStrategy& strategy) {
+  const routing::RoutingStrategy* search = &strategy;
+  std::packaged_task<Path()> request([start, end, graph, search]() {
+    return Path(graph->GetPath(start, end, *search));
+  });
+  std::shared_future<Path> route = request.get_future().share();
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    requests.push_back(std::move(request));
+  }
+  wake.notify_one();
+  return route;
+}
+
+/**
+ * @brief Answers requests until the planner is destroyed and the queue is
+ * empty.
+ */
+void PathPlanner::workerLoop() {
+  while (true) {
+    std::packaged_task<Path()> request;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      wake.wait(lock, [this]() { return stopping || !requests.empty(); });
+      if (requests.empty()) return;
+      request = std::move(requests.front());
+      requests.pop_front();
+    }
+    request();
+  }
+}
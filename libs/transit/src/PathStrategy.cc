@@ -1,5 +1,10 @@
 #include "PathStrategy.h"
 
+#include "SimulationModel.h"
+
+/// A point counts as reached once the entity is this close to it.
+static const double arrivalRadius = 4;
+
 /**
  * @brief Constructs a PathStrategy object with a given path.
  *
@@ -11,26 +16,86 @@
 PathStrategy::PathStrategy(std::vector<std::vector<float>> p)
     : path(p), index(0) {}
 
+/**
+ * @brief Computes the path from a position to a destination.
+ *
+ * Without a planner the search runs right away; otherwise it is queued and
+ * the strategy reports that it is planning until the result is in. The
+ * search is remembered with the version of the weights it uses, so move can
+ * plan the route again when they change.
+ *
+ * @param pos Start of the path in Vector3 format.
+ * @param des End of the path in Vector3 format.
+ * @param g Pointer to the graph interface used for pathfinding.
+ * @param strategy Search used on the graph.
+ * @param planner Planner running the search, or nullptr.
+ */
+void PathStrategy::plan(Vector3 pos, Vector3 des, const routing::IGraph* g,
+                        const routing::RoutingStrategy& strategy,
+                        PathPlanner* planner) {
+  this->destination = des;
+  this->graph = g;
+  this->strategy = &strategy;
+  metricVersion = strategy.MetricVersion();
+  std::vector<float> start = {static_cast<float>(pos[0]),
+                              static_cast<float>(pos[1]),
+                              static_cast<float>(pos[2])};
+  std::vector<float> end = {static_cast<float>(des[0]),
+                            static_cast<float>(des[1]),
+                            static_cast<float>(des[2])};
+  if (planner) {
+    pending = planner->plan(start, end, g, strategy);
+  } else {
+    path = g->GetPath(start, end, strategy);
+  }
+}
+
 /**
  * @brief Moves an entity along the defined path.
  *
- * This method updates the position and direction of the entity based on the
- * path defined for this strategy. It calculates the next position based on the
- * entity's current position, speed, and the time delta.
+ * Each segment is covered in one step: the entity travels straight to the
+ * point where it comes within reach of the next path point, and the time
+ * left over carries on to the following segment. A large dt therefore
+ * costs one step per path point passed instead of many small updates.
+ * A route planned with weights that have changed since is planned again
+ * from the entity's position when the model asks for it.
  *
  * @param entity Pointer to the IEntity object which is being moved.
  * @param dt The time delta in seconds.
+ * @return The time left over once the end of the path is reached.
  */
-void PathStrategy::move(IEntity* entity, double dt) {
-  if (isCompleted()) return;
-
-  Vector3 vi(path[index][0], path[index][1], path[index][2]);
-  Vector3 dir = (vi - entity->getPosition()).unit();
-
-  entity->setPosition(entity->getPosition() + dir * entity->getSpeed() * dt);
-  entity->setDirection(dir);
+double PathStrategy::move(IEntity* entity, double dt) {
+  if (isPlanning()) return 0;
+  SimulationModel* model = entity->getModel();
+  if (strategy && !isCompleted() && model && model->getReplanRoutes() &&
+      strategy->MetricVersion() != metricVersion) {
+    // the planner may have been replaced since, the model's is still alive
+    plan(entity->getPosition(), destination, graph, *strategy,
+         model->getPathPlanner());
+    index = 0;
+    if (isPlanning()) return 0;
+  }
+  double speed = entity->getSpeed();
+  while (!isCompleted() && dt > 0) {
+    Vector3 vi(path[index][0], path[index][1], path[index][2]);
+    Vector3 toPoint = vi - entity->getPosition();
+    double distance = toPoint.magnitude() - arrivalRadius;
+    if (distance <= 0) {
+      index++;
+      continue;
+    }
 
-  if (entity->getPosition().dist(vi) < 4) index++;
+    Vector3 dir = toPoint.unit();
+    entity->setDirection(dir);
+    if (speed * dt < distance) {
+      entity->setPosition(entity->getPosition() + dir * speed * dt);
+      return 0;
+    }
+    entity->setPosition(entity->getPosition() + dir * distance);
+    dt -= distance / speed;
+    index++;
+  }
+  return isCompleted() ? dt : 0;
 }
 
 /**
@@ -38,11 +103,41 @@ void PathStrategy::move(IEntity* entity, double dt) {
  *
  * @return True if the path is completed, otherwise false.
  */
-bool PathStrategy::isCompleted() { return index >= path.size(); }
+bool PathStrategy::isCompleted() {
+  return !isPlanning() && index >= path.size();
+}
+
+/**
+ * @brief Checks if the planner is still computing the path.
+ *
+ * Takes the path over once it is ready. A search that failed leaves the path
+ * empty, so the strategy completes at once.
+ *
+ * @return True if the path is not known yet, otherwise false.
+ */
+bool PathStrategy::isPlanning() {
+  if (!pending.valid()) return false;
+  if (pending.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+    return true;
+  }
+  try {
+    path = pending.get();
+  } catch (const std::exception& e) {
+    path.clear();
+  }
+  pending = std::shared_future<PathPlanner::Path>();
+  return false;
+}
 
 /**
  * @brief Retrieves the path associated with this strategy.
  *
+ * Blocks until a path that is still being planned is ready.
+ *
  * @return A vector of vector of floats representing the path coordinates.
  */
-std::vector<std::vector<float>> PathStrategy::getPath() { return path; }
+std::vector<std::vector<float>> PathStrategy::getPath() {
+  if (pending.valid()) pending.wait();
+  isPlanning();
+  return path;
+}
@@ -1,5 +1,9 @@
 #include "SimulationModel.h"
 
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
 #include "ChargerFactory.h"
 #include "DragonFactory.h"
 #include "DroneFactory.h"
@@ -8,6 +12,10 @@
 #include "HumanFactory.h"
 #include "PackageFactory.h"
 #include "RobotFactory.h"
+#include "impl/csr_graph.h"
+#include "routing/alt.h"
+#include "routing/contraction_hierarchy.h"
+#include "routing/dijkstra.h"
 
 /**
  * @brief Constructs a SimulationModel object.
@@ -34,15 +42,123 @@ SimulationModel::SimulationModel(IController& controller)
 /**
  * @brief Destructor for SimulationModel.
  *
- * Cleans up dynamically allocated memory by deleting all entities and the
- * graph.
+ * Cleans up dynamically allocated memory by deleting all entities. The graph
+ * is released with the model's reference to it.
  */
 SimulationModel::~SimulationModel() {
   // Delete dynamically allocated variables
-  for (auto& [id, entity] : entities) {
-    delete entity;
+  entities.forEach([](IEntity* entity) { delete entity; });
+}
+
+/**
+ * @brief Sets the graph used in the simulation.
+ *
+ * Contracts the graph and computes its landmark distances once up front so
+ * that routes planned with the "ch", "cch" and "alt" search strategies only
+ * run the cheap queries. Road updates made on the previous graph are lost.
+ * The routes of existing entities refer to the graph and its searches, and
+ * may be planned again on them, so the graph cannot change once there are
+ * entities.
+ *
+ * @param graph Shared handle to the IGraph object to route on.
+ * @throws std::logic_error if the model already has entities.
+ */
+void SimulationModel::setGraph(std::shared_ptr<const routing::IGraph> graph) {
+  if (graph == this->graph) return;
+  if (entities.size() > 0) {
+    throw std::logic_error("the graph cannot change while there are entities");
+  }
+  // let queued searches on the old graph finish before it goes away
+  if (planner) planner.reset(new PathPlanner(planner->getThreadCount()));
+  contractionHierarchy.reset();
+  landmarkAStar.reset();
+  customizableHierarchy.reset();
+  this->graph = std::move(graph);
+  if (auto csr = dynamic_cast<const routing::CsrGraph*>(this->graph.get())) {
+    contractionHierarchy.reset(new routing::ContractionHierarchy(*csr));
+    landmarkAStar.reset(new routing::ALT(*csr));
+    customizableHierarchy.reset(
+        new routing::CustomizableContractionHierarchy(*csr));
   }
-  delete graph;
+}
+
+/**
+ * @brief Sets the number of threads that update the entities.
+ *
+ * @param threads Number of threads, including the one calling update.
+ */
+void SimulationModel::setThreadCount(int threads) {
+  pool.reset(threads > 1 ? new ThreadPool(threads) : nullptr);
+}
+
+/**
+ * @brief Sets the number of threads that plan routes in the background.
+ *
+ * @param threads Number of planner threads, or 0 to plan synchronously.
+ */
+void SimulationModel::setPlannerThreadCount(int threads) {
+  planner.reset(threads > 0 ? new PathPlanner(threads) : nullptr);
+}
+
+/**
+ * @brief Sets whether routes are replanned after the road weights change.
+ *
+ * @param replan True to replan routes found with outdated weights.
+ */
+void SimulationModel::setReplanRoutes(bool replan) { replanRoutes = replan; }
+
+/**
+ * @brief Whether routes are replanned after the road weights change.
+ *
+ * @return True if routes found with outdated weights are replanned.
+ */
+bool SimulationModel::getReplanRoutes() const { return replanRoutes; }
+
+/**
+ * @brief Changes the weight of a road for the customizable hierarchy.
+ *
+ * The road runs along the shortest path, by the graph's own weights, between
+ * the nodes nearest to the given start and end. Only the shortcuts above its
+ * edges are customized again, so this is cheap enough to call between
+ * updates. Routes planned before keep their path unless replanning is on.
+ *
+ * @param details JsonObject with "start" and "end" positions, and either a
+ * "factor" for the road's length or "closed": true.
+ */
+void SimulationModel::updateRoad(JsonObject& details) {
+  if (!customizableHierarchy) return;
+  const routing::CsrGraph& csr = customizableHierarchy->GetGraph();
+  JsonArray start = details["start"];
+  JsonArray end = details["end"];
+  float from[3], to[3];
+  for (int i = 0; i < 3; i++) {
+    from[i] = start[i];
+    to[i] = end[i];
+  }
+  std::vector<uint32_t> road = routing::Dijkstra::Instance().GetIndexPath(
+      csr, csr.NearestIndex(from), csr.NearestIndex(to));
+
+  float factor = 1;
+  if (details.contains("factor")) factor = details["factor"];
+  if (details.contains("closed") && static_cast<bool>(details["closed"])) {
+    factor = std::numeric_limits<float>::infinity();
+  }
+  std::vector<routing::CustomizableContractionHierarchy::EdgeUpdate> updates;
+  for (size_t i = 1; i < road.size(); i++) {
+    for (int direction = 0; direction < 2; direction++) {
+      uint32_t u = direction ? road[i] : road[i - 1];
+      uint32_t v = direction ? road[i - 1] : road[i];
+      for (uint32_t e = csr.EdgeBegin(u); e < csr.EdgeEnd(u); e++) {
+        if (csr.EdgeTarget(e) == v) {
+          updates.push_back({u, v, csr.EdgeWeight(e) * factor});
+          break;
+        }
+      }
+    }
+  }
+  customizableHierarchy->UpdateEdges(updates);
+  std::cout << "road: " << start << " --> " << end << " x" << factor
+            << " (" << updates.size() << " edges)" << std::endl;
 }
 
 /**
@@ -62,8 +178,8 @@ IEntity* SimulationModel::createEntity(JsonObject& entity) {
     // std::cout << "myNewEntity: " << myNewEntity->getName() << std::endl; //
     // 这里的myNewEntity->getName()打印出来是空的，但是它却可以进入这个if之中，证明myNewEntity不是空指针。不是空指针getName（）却是空的。
     myNewEntity->linkModel(this);
+    entities.insert(myNewEntity);
     controller.addEntity(*myNewEntity);
-    entities[myNewEntity->getId()] = myNewEntity;
   }
   return myNewEntity;
 }
@@ -73,7 +189,10 @@ IEntity* SimulationModel::createEntity(JsonObject& entity) {
  *
  * @param id The ID of the entity to remove.
  */
-void SimulationModel::removeEntity(int id) { removed.insert(id); }
+void SimulationModel::removeEntity(int id) {
+  std::lock_guard<std::mutex> lock(removedMutex);
+  removed.insert(id);
+}
 
 /**
  * @brief Schedules a delivery for an object in the scene.
@@ -89,31 +208,19 @@ void SimulationModel::scheduleTrip(JsonObject& details) {
 
   Robot* receiver = nullptr;
 
-  for (auto& [id, entity] : entities) {
-    if (name == entity->getName()) {
-      if (Robot* r = dynamic_cast<Robot*>(entity)) {
-        if (r->requestedDelivery) {
-          receiver = r;
-          break;
-        }
-      }
-    }
-  }
+  entities.forEach([&](IEntity* entity) {
+    if (receiver || name != entity->getName()) return;
+    Robot* r = dynamic_cast<Robot*>(entity);
+    if (r && r->requestedDelivery) receiver = r;
+  });
 
   WeightDecorator* package = nullptr;
 
-  for (auto& [id, entity] : entities) {
-    // std::cout << "name: " << name + "_package" << std::endl;
-    // std::cout << "entity->getName(): " << entity->getName() << std::endl;
-    if (name + "_package" == entity->getName()) {
-      if (WeightDecorator* p = dynamic_cast<WeightDecorator*>(entity)) {
-        if (p->requiresDelivery) {
-          package = p;
-          break;
-        }
-      }
-    }
-  }
+  entities.forEach([&](IEntity* entity) {
+    if (package || name + "_package" != entity->getName()) return;
+    WeightDecorator* p = dynamic_cast<WeightDecorator*>(entity);
+    if (p && p->requiresDelivery) package = p;
+  });
 
   if (receiver && package) {
     package->initDelivery(receiver);
@@ -128,33 +235,211 @@ void SimulationModel::scheduleTrip(JsonObject& details) {
   }
 }
 
+/**
+ * @brief Hands scheduled deliveries to a carrier.
+ *
+ * Packages granted to the carrier at the end of the last update are returned
+ * first. During an update the queues are shared by every carrier, so instead
+ * of taking packages the request is recorded and settled by commitUpdate.
+ *
+ * @param carrier The entity that will carry the packages.
+ * @param heavy Whether to take deliveries over 50 instead of light ones.
+ * @param count Maximum number of packages to take.
+ * @return The packages for the carrier.
+ */
+std::vector<WeightDecorator*> SimulationModel::takeDeliveries(
+    const IEntity& carrier, bool heavy, int count) {
+  std::lock_guard<std::mutex> lock(deferredMutex);
+  auto claimed = claimedDeliveries.find(carrier.getId());
+  if (claimed != claimedDeliveries.end()) {
+    std::vector<WeightDecorator*> packages = std::move(claimed->second);
+    claimedDeliveries.erase(claimed);
+    return packages;
+  }
+  if (!updating) return popDeliveries(heavy, count);
+
+  // the queues only change outside of the update phase
+  if (heavy ? !scheduledDeliveriesOver50.empty()
+            : !scheduledDeliveries.empty()) {
+    claims.push_back(Claim{carrier.getId(), heavy, count});
+  }
+  return {};
+}
+
+/**
+ * @brief Takes packages from the front of one of the delivery queues.
+ *
+ * @param heavy Whether to take deliveries over 50 instead of light ones.
+ * @param count Maximum number of packages to take.
+ * @return The packages, in the order they were scheduled.
+ */
+std::vector<WeightDecorator*> SimulationModel::popDeliveries(bool heavy,
+                                                             int count) {
+  std::vector<WeightDecorator*> packages;
+  if (heavy) {
+    int taken =
+        std::min(count, static_cast<int>(scheduledDeliveriesOver50.size()));
+    packages.assign(scheduledDeliveriesOver50.begin(),
+                    scheduledDeliveriesOver50.begin() + taken);
+    scheduledDeliveriesOver50.erase(scheduledDeliveriesOver50.begin(),
+                                    scheduledDeliveriesOver50.begin() + taken);
+  } else {
+    while (static_cast<int>(packages.size()) < count &&
+           !scheduledDeliveries.empty()) {
+      packages.push_back(scheduledDeliveries.front());
+      scheduledDeliveries.pop_front();
+    }
+  }
+  return packages;
+}
+
+/**
+ * @brief Gives a delivered package to its owner and reports it to the
+ * controller.
+ *
+ * Sends a "DeliveryCompleted" event whose name matches the one the trip was
+ * scheduled with. During an update the hand-off waits for commitUpdate, as
+ * several carriers may finish at once.
+ *
+ * @param package The delivered package.
+ * @param owner The robot receiving the package.
+ */
+void SimulationModel::completeDelivery(WeightDecorator* package,
+                                       Robot* owner) {
+  if (updating) {
+    std::lock_guard<std::mutex> lock(deferredMutex);
+    completedDeliveries.emplace_back(package, owner);
+    return;
+  }
+  owner->receive(package);
+  JsonObject details;
+  details["name"] = owner->getName();
+  details["package"] = package->getId();
+  controller.sendEventToView("DeliveryCompleted", details);
+}
+
 /**
  * @brief Retrieves the graph used in the simulation.
  *
  * @return Pointer to the IGraph object representing the graph used in the
  * simulation.
  */
-const routing::IGraph* SimulationModel::getGraph() { return graph; }
+const routing::IGraph* SimulationModel::getGraph() { return graph.get(); }
+
+/**
+ * @brief Retrieves the contraction hierarchy of the simulation's graph.
+ *
+ * @return Pointer to the hierarchy, or nullptr if the graph is not a
+ * CsrGraph.
+ */
+const routing::RoutingStrategy* SimulationModel::getContractionHierarchy() {
+  return contractionHierarchy.get();
+}
+
+/**
+ * @brief Retrieves the customizable contraction hierarchy of the simulation's
+ * graph.
+ *
+ * @return Pointer to the hierarchy, or nullptr if the graph is not a
+ * CsrGraph.
+ */
+const routing::RoutingStrategy* SimulationModel::getCustomizableHierarchy() {
+  return customizableHierarchy.get();
+}
+
+/**
+ * @brief Retrieves the landmark guided A* of the simulation's graph.
+ *
+ * @return Pointer to the search, or nullptr if the graph is not a CsrGraph.
+ */
+const routing::RoutingStrategy* SimulationModel::getLandmarkAStar() {
+  return landmarkAStar.get();
+}
+
+/**
+ * @brief Retrieves the planner that computes routes in the background.
+ *
+ * @return Pointer to the planner, or nullptr if routes are planned inside the
+ * update that requests them.
+ */
+PathPlanner* SimulationModel::getPathPlanner() { return planner.get(); }
 
 /**
  * @brief Updates the simulation.
  *
- * This method updates each entity and the controller based on the time delta.
+ * Runs in two phases. First every entity is updated, split over the thread
+ * pool if there is one; entities only change their own state then and leave
+ * requests for shared state with the model. Then, on this thread, those
+ * requests are applied in a fixed order, the controller is told about every
+ * entity and removed entities are deleted. The outcome is the same for any
+ * number of threads.
  *
  * @param dt The time delta in seconds.
  */
 /// Updates the simulation
 void SimulationModel::update(double dt) {
-  for (auto& [id, entity] : entities) {
-    entity->update(dt);
-    controller.updateEntity(*entity);
+  updating = true;
+  if (pool) {
+    // contiguous runs of one kind, small enough to balance the threads
+    const size_t grain = 16;
+    std::vector<std::pair<IEntity* const*, size_t>> chunks;
+    for (const EntityStore::Kind& kind : entities.getKinds()) {
+      for (size_t i = 0; i < kind.entities.size(); i += grain) {
+        chunks.emplace_back(&kind.entities[i],
+                            std::min(grain, kind.entities.size() - i));
+      }
+    }
+    pool->parallelFor(chunks.size(), [&](int chunk) {
+      for (size_t i = 0; i < chunks[chunk].second; i++) {
+        chunks[chunk].first[i]->update(dt);
+      }
+    });
+  } else {
+    entities.forEach([&](IEntity* entity) { entity->update(dt); });
   }
+  updating = false;
+
+  commitUpdate();
+
+  entities.forEach(
+      [&](IEntity* entity) { controller.updateEntity(*entity); });
   for (int id : removed) {
     removeFromSim(id);
   }
   removed.clear();
 }
 
+/**
+ * @brief Applies the changes to shared state requested during an update.
+ *
+ * Finished deliveries are handed off in package id order, then the delivery
+ * claims are granted in carrier id order, each carrier taking from the front
+ * of its queue.
+ */
+void SimulationModel::commitUpdate() {
+  std::sort(completedDeliveries.begin(), completedDeliveries.end(),
+            [](const std::pair<WeightDecorator*, Robot*>& a,
+               const std::pair<WeightDecorator*, Robot*>& b) {
+              return a.first->getId() < b.first->getId();
+            });
+  for (const auto& delivery : completedDeliveries) {
+    completeDelivery(delivery.first, delivery.second);
+  }
+  completedDeliveries.clear();
+
+  std::sort(claims.begin(), claims.end(),
+            [](const Claim& a, const Claim& b) { return a.carrier < b.carrier; });
+  for (const Claim& claim : claims) {
+    if (claimedDeliveries.count(claim.carrier)) continue;
+    std::vector<WeightDecorator*> packages =
+        popDeliveries(claim.heavy, claim.count);
+    if (!packages.empty()) {
+      claimedDeliveries[claim.carrier] = std::move(packages);
+    }
+  }
+  claims.clear();
+}
+
 /**
  * @brief Stops the simulation.
  */
@@ -168,7 +453,7 @@ void SimulationModel::stop(void) { controller.stop(); }
  * @param id The ID of the entity to remove.
  */
 void SimulationModel::removeFromSim(int id) {
-  IEntity* entity = entities[id];
+  IEntity* entity = entities.get(id);
   if (entity) {
     for (auto i = scheduledDeliveries.begin(); i != scheduledDeliveries.end();
          ++i) {
@@ -177,8 +462,29 @@ void SimulationModel::removeFromSim(int id) {
         break;
       }
     }
+    scheduledDeliveriesOver50.erase(
+        std::remove(scheduledDeliveriesOver50.begin(),
+                    scheduledDeliveriesOver50.end(), entity),
+        scheduledDeliveriesOver50.end());
+
+    // packages granted to a carrier that never picked them up go back
+    // to the front of their queue
+    auto claimed = claimedDeliveries.find(id);
+    if (claimed != claimedDeliveries.end()) {
+      for (auto p = claimed->second.rbegin(); p != claimed->second.rend();
+           ++p) {
+        if ((*p)->getWeight() <= 50) {
+          scheduledDeliveries.push_front(*p);
+        } else {
+          scheduledDeliveriesOver50.insert(scheduledDeliveriesOver50.begin(),
+                                           *p);
+        }
+      }
+      claimedDeliveries.erase(claimed);
+    }
+
     controller.removeEntity(*entity);
-    entities.erase(id);
+    entities.remove(id);
     delete entity;
   }
 }
@@ -0,0 +1,153 @@
+#include "ThreadPool.h"
+
+/**
+ * @brief Creates the queues and starts threads - 1 workers.
+ *
+ * @param threads Number of threads working on a loop, including the caller.
+ */
+ThreadPool::ThreadPool(int threads) {
+  if (threads < 1) threads = 1;
+  for (int i = 0; i < threads; i++) {
+    queues.emplace_back(new Queue());
+  }
+  for (int i = 1; i < threads; i++) {
+    workers.emplace_back(&ThreadPool::workerLoop, this, i);
+  }
+}
+
+/**
+ * @brief Wakes the idle workers so they exit, then joins them.
+ */
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  wake.notify_all();
+  for (std::thread& worker : workers) {
+    worker.join();
+  }
+}
+
+/**
+ * @brief Runs an indexed loop on every thread of the pool.
+ *
+ * The calling thread takes part as the first worker and returns once every
+ * item is done.
+ *
+ * @param count Number of items.
+ * @param task Work for one item.
+ */
+void ThreadPool::parallelFor(int count, const std::function<void(int)>& task) {
+  if (count <= 0) return;
+  if (workers.empty() || count == 1) {
+    for (int i = 0; i < count; i++) {
+      task(i);
+    }
+    return;
+  }
+
+  const int threads = queues.size();
+  for (int t = 0; t < threads; t++) {
+    std::lock_guard<std::mutex> lock(queues[t]->mutex);
+    for (int i = count * t / threads; i < count * (t + 1) / threads; i++) {
+      queues[t]->items.push_back(i);
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    job = &task;
+    error = nullptr;
+    busy = workers.size();
+    generation++;
+  }
+  wake.notify_all();
+
+  work(0);
+
+  std::unique_lock<std::mutex> lock(mutex);
+  done.wait(lock, [this]() { return busy == 0; });
+  job = nullptr;
+  if (error) {
+    std::exception_ptr thrown = error;
+    error = nullptr;
+    std::rethrow_exception(thrown);
+  }
+}
+
+/**
+ * @brief Waits for loops to join until the pool is destroyed.
+ *
+ * @param self Index of the worker's queue.
+ */
+void ThreadPool::workerLoop(int self) {
+  int seen = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      wake.wait(lock, [&]() { return stopping || generation != seen; });
+      if (stopping) return;
+      seen = generation;
+    }
+
+    work(self);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (--busy == 0) done.notify_one();
+  }
+}
+
+/**
+ * @brief Runs items until no queue has any left.
+ *
+ * @param self Index of the thread's own queue.
+ */
+void ThreadPool::work(int self) {
+  int item;
+  while (pop(self, &item) || steal(self, &item)) {
+    try {
+      (*job)(item);
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (!error) error = std::current_exception();
+    }
+  }
+}
+
+/**
+ * @brief Takes the next item of the thread's own block.
+ *
+ * @param self Index of the thread's queue.
+ * @param item Receives the item.
+ * @return False if the queue is empty.
+ */
+bool ThreadPool::pop(int self, int* item) {
+  Queue& queue = *queues[self];
+  std::lock_guard<std::mutex> lock(queue.mutex);
+  if (queue.items.empty()) return false;
+  *item = queue.items.back();
+  queue.items.pop_back();
+  return true;
+}
+
+/**
+ * @brief Takes an item from the far end of another thread's block.
+ *
+ * @param self Index of the stealing thread's queue.
+ * @param item Receives the item.
+ * @return False if every other queue is empty.
+ */
+bool ThreadPool::steal(int self, int* item) {
+  const int threads = queues.size();
+  for (int offset = 1; offset < threads; offset++) {
+    Queue& queue = *queues[(self + offset) % threads];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (!queue.items.empty()) {
+      *item = queue.items.front();
+      queue.items.pop_front();
+      return true;
+    }
+  }
+  return false;
+}
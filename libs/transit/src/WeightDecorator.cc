@@ -1,6 +1,7 @@
 #include "WeightDecorator.h"
 
 #include "Robot.h"
+#include "SimulationModel.h"
 
 /**
  * @brief Decorates a package with additional weight-related functionality.
@@ -14,7 +15,7 @@
 WeightDecorator::WeightDecorator(Package* package) : package(package) {
   weight = std::stod(package->getDetails()["weight"]);
   requiresDelivery = true;
-  position = package->getPosition();
+  setPosition(package->getPosition());
 }
 
 /**
@@ -90,25 +91,22 @@ std::string WeightDecorator::getName() const { return package->getName(); }
  */
 double WeightDecorator::getWeight() const { return weight; }
 
-/**
- * @brief Retrieves the current position of the decorated package.
- *
- * @return The position as a Vector3 object.
- */
-Vector3 WeightDecorator::getPosition() const { return position; }
-
 /**
  * @brief Hands off the decorated package to its owner.
  *
  * This method is responsible for transferring the responsibility of the package
- * to its owner Robot.
+ * to its owner Robot and reporting the delivery to the model.
  */
 void WeightDecorator::handOff() {
   // Get the owner from the wrapped Package object
   Robot* packageOwner = package->getOwner();
 
   if (packageOwner) {
-    packageOwner->receive(this);
+    if (model) {
+      model->completeDelivery(this, packageOwner);
+    } else {
+      packageOwner->receive(this);
+    }
   }
 }
 
@@ -118,6 +116,6 @@ void WeightDecorator::handOff() {
  * @param pos_ The new position as a Vector3 object.
  */
 void WeightDecorator::setPosition(Vector3 pos_) {
-  position = pos_;
+  IEntity::setPosition(pos_);
   package->setPosition(pos_);
 }